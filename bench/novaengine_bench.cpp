@@ -0,0 +1,397 @@
+// novaengine_bench: sender and receiver in one process over loopback (or a veth pair),
+// so glass-to-glass latency is measured on a single steady_clock.
+//
+// Every source frame gets a 24-bit sequence number painted into its top luma rows; the
+// receiver reads it back from the decoded picture. The match therefore survives encoder
+// buffering, capture-side drops and frame loss without any side channel.
+//
+// Usage: novaengine_bench [options]
+//   --target <ip>          destination address (default 127.0.0.1; a veth peer works too)
+//   --port <n>             receiver port (default 47000)
+//   --source <spec>        synthetic[:complexity] (default synthetic:0.5), file.y4m, file.yuv
+//   --width/--height <n>   frame size for synthetic and raw .yuv sources (default 640x480)
+//   --fps <n>              source frame rate (default 30)
+//   --bitrate <bps>        encoder target (default 600000)
+//   --adaptive             let the congestion controller move the bitrate (fixed otherwise)
+//   --k <n> --r <n>        FEC data / parity blocks per group (default 8 / 4)
+//   --warmup <s>           excluded from the results (default 2)
+//   --duration <s>         measurement window (default 10)
+//
+// Network impairment on the media path (NetworkImpairment, seeded; feedback is not impaired):
+//   --loss <p>             independent loss probability
+//   --burst-loss <p>,<r>   Gilbert–Elliott GOOD→BAD / BAD→GOOD, everything lost while BAD
+//   --delay <ms>           base one-way delay
+//   --jitter <ms>          delay deviation, see --jitter-dist (uniform, normal, pareto)
+//   --reorder <p>          probability a packet is held back 10 ms and overtaken
+//   --duplicate <p>        duplication probability
+//   --rate <bps>           token-bucket bandwidth cap, --queue <bytes> its tail-drop limit
+//   --seed <n>             RNG seed (default 1)
+
+#include "sender_receiver.hpp"
+#include "frame_source.hpp"
+#include "network_impairment.hpp"
+
+#include <opencv2/core.hpp>
+
+#include <sys/resource.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+typedef chrono::steady_clock Clock;
+
+namespace {
+
+// Stamp: 32 blocks across the top STAMP_ROWS luma rows, 24 sequence bits and an 8-bit check,
+// black/white so it survives any sane bitrate
+constexpr int STAMP_BITS = 32;
+constexpr int STAMP_ROWS = 16;
+constexpr uint8_t STAMP_ZERO = 16;
+constexpr uint8_t STAMP_ONE = 235;
+constexpr uint32_t SEQUENCE_MASK = 0xFFFFFF;
+
+// Capture times are kept for this many recent frames; far more than any frame spends in flight
+constexpr size_t CAPTURE_HISTORY = 4096;
+
+// In-flight frames get this long to arrive after the window closes
+constexpr auto DRAIN_TIME = chrono::milliseconds(500);
+
+int64_t now_us() {
+    return chrono::duration_cast<chrono::microseconds>(Clock::now().time_since_epoch()).count();
+}
+
+uint32_t stamp_word(uint32_t seq) {
+    seq &= SEQUENCE_MASK;
+    uint32_t check = (seq ^ (seq >> 8) ^ (seq >> 16) ^ 0x5A) & 0xFF;
+    return (seq << 8) | check;
+}
+
+void paint_stamp(cv::Mat& i420, int width, int height, uint32_t seq) {
+    const uint32_t word = stamp_word(seq);
+    const int block = width / STAMP_BITS;
+    for (int y = 0; y < STAMP_ROWS; ++y) {
+        uint8_t* row = i420.data + static_cast<size_t>(y) * width;
+        for (int b = 0; b < STAMP_BITS; ++b)
+            memset(row + b * block, (word >> (31 - b)) & 1 ? STAMP_ONE : STAMP_ZERO, block);
+    }
+    // Neutral chroma under the stamp, so it decodes as pure grey levels
+    uint8_t* u_plane = i420.data + static_cast<size_t>(width) * height;
+    uint8_t* v_plane = u_plane + static_cast<size_t>(width / 2) * (height / 2);
+    for (int y = 0; y < STAMP_ROWS / 2; ++y) {
+        memset(u_plane + static_cast<size_t>(y) * (width / 2), 128, width / 2);
+        memset(v_plane + static_cast<size_t>(y) * (width / 2), 128, width / 2);
+    }
+}
+
+// Reads the stamp from a decoded BGR frame; false when the check byte does not match
+bool read_stamp(const cv::Mat& bgr, uint32_t& seq) {
+    const int block = bgr.cols / STAMP_BITS;
+    if (block < 4 || bgr.rows < STAMP_ROWS || bgr.type() != CV_8UC3) return false;
+
+    uint32_t word = 0;
+    for (int b = 0; b < STAMP_BITS; ++b) {
+        // Centre of the block only: edges blur into the neighbours
+        unsigned sum = 0, count = 0;
+        for (int y = STAMP_ROWS / 4; y < STAMP_ROWS * 3 / 4; ++y) {
+            const uint8_t* row = bgr.data + static_cast<size_t>(y) * bgr.step;
+            for (int x = b * block + block / 4; x < b * block + block * 3 / 4; ++x) {
+                sum += row[x * 3 + 1];
+                ++count;
+            }
+        }
+        word = (word << 1) | (sum > count * 128 ? 1u : 0u);
+    }
+    seq = word >> 8;
+    return stamp_word(seq) == word;
+}
+
+// Capture times indexed by sequence number, written on the capture thread, read on decode
+class CaptureLog {
+public:
+    void record(uint32_t seq, int64_t t_us) {
+        times_[seq % CAPTURE_HISTORY].store(t_us, memory_order_release);
+    }
+    int64_t lookup(uint32_t seq) const {
+        return times_[seq % CAPTURE_HISTORY].load(memory_order_acquire);
+    }
+
+private:
+    array<atomic<int64_t>, CAPTURE_HISTORY> times_{};
+};
+
+// Measurement window: frames captured in [start, end) are counted
+struct Window {
+    int64_t start_us = 0;
+    int64_t end_us = 0;
+    atomic<int64_t> first_seq{-1};
+    atomic<int64_t> last_seq{-1};
+
+    bool contains(int64_t t_us) const { return t_us >= start_us && t_us < end_us; }
+};
+
+// Wraps the real source: copies read-only frames, paints the sequence, logs the capture time
+class StampingSource : public FrameSource {
+public:
+    StampingSource(shared_ptr<FrameSource> inner, CaptureLog& log, Window& window)
+        : inner_(move(inner)), log_(log), window_(window) {
+        if (inner_->format() != FrameFormat::I420)
+            throw runtime_error("the bench stamps I420 frames; use a synthetic or file source");
+        if (inner_->width() / STAMP_BITS < 8)
+            throw runtime_error("frames must be at least 256 pixels wide to carry the stamp");
+    }
+
+    bool read(cv::Mat& frame) override {
+        if (inner_->frames_writable()) {
+            if (!inner_->read(frame)) return false;
+        } else {
+            if (!inner_->read(view_)) return false;
+            view_.copyTo(frame);
+        }
+        const uint32_t seq = next_seq_++ & SEQUENCE_MASK;
+        paint_stamp(frame, width(), height(), seq);
+
+        const int64_t t = now_us();
+        log_.record(seq, t);
+        if (window_.contains(t)) {
+            if (window_.first_seq.load(memory_order_relaxed) < 0) window_.first_seq.store(seq, memory_order_relaxed);
+            window_.last_seq.store(seq, memory_order_relaxed);
+        }
+        return true;
+    }
+
+    FrameFormat format() const override { return inner_->format(); }
+    int width() const override { return inner_->width(); }
+    int height() const override { return inner_->height(); }
+    int fps() const override { return inner_->fps(); }
+    string describe() const override { return inner_->describe() + ", stamped"; }
+
+private:
+    shared_ptr<FrameSource> inner_;
+    CaptureLog& log_;
+    Window& window_;
+    cv::Mat view_;
+    uint32_t next_seq_ = 0;
+};
+
+struct Snapshot {
+    int64_t t_us = 0;
+    double cpu_s = 0.0;
+    uint64_t frames_sent = 0;
+    uint64_t datagrams_sent = 0;
+    uint64_t bytes_sent = 0;
+    uint64_t datagrams_received = 0;
+};
+
+Snapshot take_snapshot(const RunCounters& counters) {
+    Snapshot s;
+    s.t_us = now_us();
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    s.cpu_s = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+              usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+    s.frames_sent = counters.frames_sent.load(memory_order_relaxed);
+    s.datagrams_sent = counters.datagrams_sent.load(memory_order_relaxed);
+    s.bytes_sent = counters.bytes_sent.load(memory_order_relaxed);
+    s.datagrams_received = counters.datagrams_received.load(memory_order_relaxed);
+    return s;
+}
+
+// Nearest-rank percentile of sorted values
+double percentile(const vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = static_cast<size_t>(ceil(p * sorted.size()));
+    return sorted[min(max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+DelayDistribution parse_distribution(const string& name) {
+    if (name == "constant") return DelayDistribution::CONSTANT;
+    if (name == "uniform") return DelayDistribution::UNIFORM;
+    if (name == "normal") return DelayDistribution::NORMAL;
+    if (name == "pareto") return DelayDistribution::PARETO;
+    throw invalid_argument("unknown jitter distribution " + name);
+}
+
+void usage(const char* argv0) {
+    cerr << "Usage: " << argv0 << " [--target ip] [--port n] [--source spec] [--width n] [--height n]"
+         << " [--fps n] [--bitrate bps] [--adaptive] [--k n] [--r n] [--warmup s] [--duration s]"
+         << " [--loss p] [--burst-loss p,r] [--delay ms] [--jitter ms] [--jitter-dist name]"
+         << " [--reorder p] [--duplicate p] [--rate bps] [--queue bytes] [--seed n]" << endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    string target_ip = "127.0.0.1";
+    int port = 47000;
+    string source_spec = "synthetic:0.5";
+    double warmup_s = 2.0;
+    double duration_s = 10.0;
+    RunOptions options;
+    options.headless = true;
+    options.adapt_bitrate = false;
+    ImpairmentConfig impairment;
+    uint64_t seed = 1;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            string arg = argv[i];
+            auto value = [&]() -> string {
+                if (i + 1 >= argc) throw invalid_argument(arg + " needs a value");
+                return argv[++i];
+            };
+            if (arg == "--target") target_ip = value();
+            else if (arg == "--port") port = stoi(value());
+            else if (arg == "--source") source_spec = value();
+            else if (arg == "--width") options.width = stoi(value());
+            else if (arg == "--height") options.height = stoi(value());
+            else if (arg == "--fps") options.fps = stoi(value());
+            else if (arg == "--bitrate") options.bitrate = stoi(value());
+            else if (arg == "--adaptive") options.adapt_bitrate = true;
+            else if (arg == "--k") options.fec_k = stoi(value());
+            else if (arg == "--r") options.fec_r = stoi(value());
+            else if (arg == "--warmup") warmup_s = stod(value());
+            else if (arg == "--duration") duration_s = stod(value());
+            else if (arg == "--loss") impairment.loss_good = stod(value());
+            else if (arg == "--burst-loss") {
+                string v = value();
+                size_t comma = v.find(',');
+                if (comma == string::npos) throw invalid_argument("--burst-loss takes p,r");
+                impairment.good_to_bad = stod(v.substr(0, comma));
+                impairment.bad_to_good = stod(v.substr(comma + 1));
+            }
+            else if (arg == "--delay") impairment.delay_ms = stod(value());
+            else if (arg == "--jitter") impairment.jitter_ms = stod(value());
+            else if (arg == "--jitter-dist") impairment.distribution = parse_distribution(value());
+            else if (arg == "--reorder") impairment.reorder = stod(value());
+            else if (arg == "--duplicate") impairment.duplicate = stod(value());
+            else if (arg == "--rate") impairment.rate_bps = stoll(value());
+            else if (arg == "--queue") impairment.queue_limit_bytes = stoul(value());
+            else if (arg == "--seed") seed = stoull(value());
+            else throw invalid_argument("unknown option " + arg);
+        }
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        usage(argv[0]);
+        return 1;
+    }
+
+    const bool impaired = impairment.loss_good > 0 || impairment.good_to_bad > 0 || impairment.delay_ms > 0 ||
+                          impairment.jitter_ms > 0 || impairment.reorder > 0 || impairment.duplicate > 0 ||
+                          impairment.rate_bps > 0;
+
+    CaptureLog capture_log;
+    Window window;
+    const int64_t start_us = now_us();
+    window.start_us = start_us + static_cast<int64_t>(warmup_s * 1e6);
+    window.end_us = window.start_us + static_cast<int64_t>(duration_s * 1e6);
+
+    try {
+        if (source_spec.compare(0, 6, "camera") == 0)
+            throw runtime_error("camera frames cannot be stamped; use a synthetic or file source");
+        shared_ptr<FrameSource> source = open_frame_source(source_spec, options.width, options.height, options.fps);
+        options.frame_source = make_shared<StampingSource>(source, capture_log, window);
+    } catch (const exception& e) {
+        cerr << "[BENCH] " << e.what() << endl;
+        return 1;
+    }
+
+    // Decode side, all on the receiver's decode thread
+    vector<double> latencies_ms;
+    latencies_ms.reserve(static_cast<size_t>(duration_s * options.fps * 1.5) + 16);
+    uint64_t unreadable = 0;
+    options.on_decoded = [&](const cv::Mat& frame) {
+        const int64_t t = now_us();
+        uint32_t seq;
+        if (!read_stamp(frame, seq)) {
+            ++unreadable;
+            return;
+        }
+        const int64_t captured = capture_log.lookup(seq);
+        if (window.contains(captured)) latencies_ms.push_back((t - captured) / 1000.0);
+    };
+
+    RunCounters counters;
+    atomic<bool> stop{false};
+    options.counters = &counters;
+    options.stop = &stop;
+    options.local_ports = {0};
+
+    cout << "[BENCH] " << options.frame_source->describe() << " → " << target_ip << ":" << port
+         << ", " << options.bitrate / 1000 << " kbps" << (options.adapt_bitrate ? " (adaptive)" : "")
+         << ", FEC " << options.fec_k << "+" << options.fec_r
+         << ", warmup " << warmup_s << "s, window " << duration_s << "s" << endl;
+
+    // The sender session's sockets hand datagrams to the emulator until the session stops
+    shared_ptr<NetworkImpairment> network;
+    if (impaired) {
+        network = make_shared<NetworkImpairment>(vector<ImpairmentConfig>{impairment}, seed);
+        options.impairment = network;
+        cout << "[BENCH] Impairment: loss " << impairment.loss_good
+             << ", burst " << impairment.good_to_bad << "/" << impairment.bad_to_good
+             << ", delay " << impairment.delay_ms << "±" << impairment.jitter_ms << "ms"
+             << ", reorder " << impairment.reorder << ", duplicate " << impairment.duplicate
+             << ", rate " << impairment.rate_bps / 1000 << " kbps, seed " << seed << endl;
+    }
+
+    thread receiver([&]() { run_receiver({port}, options); });
+    this_thread::sleep_for(chrono::milliseconds(100));   // receiver socket bound before media flows
+    thread sender([&]() { run_sender(target_ip, {port}, options); });
+
+    auto at = [](int64_t t_us) { return Clock::time_point(chrono::microseconds(t_us)); };
+    this_thread::sleep_until(at(window.start_us));
+    Snapshot begin = take_snapshot(counters);
+    this_thread::sleep_until(at(window.end_us));
+    Snapshot end = take_snapshot(counters);
+    this_thread::sleep_for(DRAIN_TIME);
+
+    stop = true;
+    sender.join();
+    receiver.join();
+
+    // Glass to glass here is source read → decoded picture; display is not part of the bench
+    const double seconds = (end.t_us - begin.t_us) / 1e6;
+    const int64_t first = window.first_seq.load();
+    const int64_t last = window.last_seq.load();
+    const uint64_t captured = first >= 0 ? static_cast<uint64_t>(last - first + 1) : 0;
+    const uint64_t matched = latencies_ms.size();
+    const uint64_t lost = captured > matched ? captured - matched : 0;
+    const double cpu_s = end.cpu_s - begin.cpu_s;
+
+    sort(latencies_ms.begin(), latencies_ms.end());
+    double mean = 0.0;
+    for (double v : latencies_ms) mean += v;
+    if (matched) mean /= matched;
+
+    printf("\n=== novaengine_bench: %.1fs window ===\n", seconds);
+    printf("frames      captured %llu, decoded %llu, lost %llu (%.2f%%), unreadable stamps %llu\n",
+           (unsigned long long)captured, (unsigned long long)matched, (unsigned long long)lost,
+           captured ? 100.0 * lost / captured : 0.0, (unsigned long long)unreadable);
+    printf("latency ms  p50 %.2f  p99 %.2f  p99.9 %.2f  mean %.2f  max %.2f\n",
+           percentile(latencies_ms, 0.50), percentile(latencies_ms, 0.99), percentile(latencies_ms, 0.999),
+           mean, latencies_ms.empty() ? 0.0 : latencies_ms.back());
+    printf("packets/s   sent %.0f  received %.0f  (%.0f kbps on the wire)\n",
+           (end.datagrams_sent - begin.datagrams_sent) / seconds,
+           (end.datagrams_received - begin.datagrams_received) / seconds,
+           (end.bytes_sent - begin.bytes_sent) * 8 / seconds / 1000);
+    printf("cpu         %.1f%% of one core, %.2f ms per decoded frame (sender + receiver)\n",
+           100.0 * cpu_s / seconds, matched ? 1000.0 * cpu_s / matched : 0.0);
+    if (network) {
+        // Whole run, warmup included
+        ImpairmentStats n = network->stats(0);
+        printf("network     submitted %llu, lost %llu, queue drops %llu, reordered %llu, duplicated %llu\n",
+               (unsigned long long)n.submitted, (unsigned long long)n.lost, (unsigned long long)n.queue_drops,
+               (unsigned long long)n.reordered, (unsigned long long)n.duplicated);
+    }
+    return matched > 0 ? 0 : 2;
+}
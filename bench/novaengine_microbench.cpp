@@ -0,0 +1,421 @@
+// novaengine_microbench: the packet, slicing, FEC, collector and scheduler hot paths at
+// realistic sizes, reported as JSON so results can be stored and compared per commit.
+//
+// Usage: novaengine_microbench [--filter <substring>] [--min-time <s>] [--out <file>]
+//
+// Every case runs in batches sized to take ~10 ms until --min-time (default 0.5 s) has passed;
+// ns_per_op is the mean over all batches, ns_per_op_min the fastest batch (least noisy).
+
+#include "packet_parser.hpp"
+#include "slicer.hpp"
+#include "erasure_coder.hpp"
+#include "smart_collector.hpp"
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifndef NOVAENGINE_GIT_COMMIT
+#define NOVAENGINE_GIT_COMMIT "unknown"
+#endif
+
+using namespace std;
+typedef chrono::steady_clock Clock;
+
+namespace {
+
+constexpr auto BATCH_TARGET = chrono::milliseconds(10);
+
+// Keeps the optimizer from discarding a result
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct Result {
+    string name;
+    vector<pair<string, string>> params;   // already JSON-encoded values
+    uint64_t iterations = 0;
+    double ns_per_op = 0.0;
+    double ns_per_op_min = 0.0;
+    double bytes_per_op = 0.0;             // 0: no throughput figure
+};
+
+struct Options {
+    string filter;
+    double min_time_s = 0.5;
+    string out;
+};
+
+string json_string(const string& s) {
+    string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+class Suite {
+public:
+    explicit Suite(const Options& options) : options_(options) {}
+
+    // op runs one operation; bytes_per_op > 0 adds a throughput figure
+    void run(const string& name, vector<pair<string, string>> params, double bytes_per_op,
+             const function<void()>& op) {
+        if (!options_.filter.empty() && name.find(options_.filter) == string::npos) return;
+
+        // Warm caches and size the batch
+        uint64_t batch = 1;
+        for (;;) {
+            auto t0 = Clock::now();
+            for (uint64_t i = 0; i < batch; ++i) op();
+            if (Clock::now() - t0 >= BATCH_TARGET || batch >= (1ull << 30)) break;
+            batch *= 2;
+        }
+
+        Result result;
+        result.name = name;
+        result.params = move(params);
+        result.bytes_per_op = bytes_per_op;
+        result.ns_per_op_min = 1e300;
+        double total_ns = 0.0;
+        const auto deadline = Clock::now() + chrono::duration<double>(options_.min_time_s);
+        do {
+            auto t0 = Clock::now();
+            for (uint64_t i = 0; i < batch; ++i) op();
+            double ns = chrono::duration<double, nano>(Clock::now() - t0).count();
+            total_ns += ns;
+            result.iterations += batch;
+            result.ns_per_op_min = min(result.ns_per_op_min, ns / batch);
+        } while (Clock::now() < deadline);
+        result.ns_per_op = total_ns / result.iterations;
+
+        cerr << "  " << name;
+        for (const auto& p : result.params) cerr << " " << p.first << "=" << p.second;
+        cerr << ": " << result.ns_per_op << " ns/op";
+        if (bytes_per_op > 0) cerr << ", " << bytes_per_op / result.ns_per_op * 1000.0 << " MB/s";
+        cerr << endl;
+        results_.push_back(move(result));
+    }
+
+    string json() const {
+        char timestamp[32];
+        time_t now = time(nullptr);
+        strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+        ostringstream out;
+        out.precision(6);
+        out << "{\n"
+            << "  \"suite\": \"novaengine_microbench\",\n"
+            << "  \"commit\": " << json_string(NOVAENGINE_GIT_COMMIT) << ",\n"
+            << "  \"timestamp\": \"" << timestamp << "\",\n"
+            << "  \"cpus\": " << thread::hardware_concurrency() << ",\n"
+#ifdef __VERSION__
+            << "  \"compiler\": " << json_string(__VERSION__) << ",\n"
+#endif
+            << "  \"min_time_s\": " << options_.min_time_s << ",\n"
+            << "  \"results\": [";
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const Result& r = results_[i];
+            out << (i ? ",\n" : "\n") << "    {\"name\": " << json_string(r.name) << ", \"params\": {";
+            for (size_t p = 0; p < r.params.size(); ++p)
+                out << (p ? ", " : "") << json_string(r.params[p].first) << ": " << r.params[p].second;
+            out << "}, \"iterations\": " << r.iterations
+                << ", \"ns_per_op\": " << r.ns_per_op
+                << ", \"ns_per_op_min\": " << r.ns_per_op_min;
+            if (r.bytes_per_op > 0)
+                out << ", \"bytes_per_op\": " << r.bytes_per_op
+                    << ", \"mb_per_s\": " << r.bytes_per_op / r.ns_per_op * 1000.0;
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+        return out.str();
+    }
+
+private:
+    const Options& options_;
+    vector<Result> results_;
+};
+
+string num(double v) {
+    ostringstream out;
+    out << v;
+    return out.str();
+}
+
+vector<uint8_t> random_bytes(size_t size, mt19937& rng) {
+    vector<uint8_t> data(size);
+    for (auto& b : data) b = static_cast<uint8_t>(rng());
+    return data;
+}
+
+// ---------------------------------------------------------------------------
+
+void bench_packets(Suite& suite, mt19937& rng) {
+    for (size_t payload : {256, 1000, 1400}) {
+        ChunkPacket pkt;
+        pkt.k = 8;
+        pkt.r = 4;
+        pkt.block_index = 3;
+        pkt.group_index = 1;
+        pkt.block_size = static_cast<uint16_t>(payload);
+        pkt.frame_id = 1234;
+        pkt.frame_length = static_cast<uint32_t>(payload * 16);
+        pkt.timestamp = 42;
+        pkt.payload = random_bytes(payload, rng);
+        const vector<uint8_t> wire = serialize_packet(pkt);
+        const double bytes = static_cast<double>(wire.size());
+        vector<pair<string, string>> params = {{"payload", num(payload)}};
+
+        suite.run("packet/serialize_packet", params, bytes, [&] {
+            vector<uint8_t> out = serialize_packet(pkt);
+            keep(out);
+        });
+        suite.run("packet/parse_packet", params, bytes, [&] {
+            ChunkPacket parsed = parse_packet(wire.data(), wire.size());
+            keep(parsed);
+        });
+        suite.run("packet/parse_packet_view", params, bytes, [&] {
+            PacketView view;
+            bool ok = parse_packet_view(wire.data(), wire.size(), view);
+            keep(ok);
+            keep(view);
+        });
+    }
+}
+
+void bench_slicing(Suite& suite, mt19937& rng) {
+    for (size_t frame_size : {4096, 30000, 200000, 1000000}) {
+        const vector<uint8_t> frame = random_bytes(frame_size, rng);
+        suite.run("slice/slice_frame", {{"frame_size", num(frame_size)}, {"chunk_size", "1000"}},
+                  static_cast<double>(frame_size), [&] {
+            vector<Chunk> chunks = slice_frame(frame, 7, 1000);
+            keep(chunks);
+        });
+    }
+}
+
+void bench_fec(Suite& suite, mt19937& rng) {
+    const size_t block_size = 1000;
+    for (auto shape : {make_pair(8, 4), make_pair(16, 4), make_pair(4, 2)}) {
+        const int k = shape.first;
+        const int r = shape.second;
+        ErasureCoder coder(k, r);
+
+        // One group as a contiguous block matrix: k data blocks, then r parity blocks
+        vector<uint8_t> matrix = random_bytes((k + r) * block_size, rng);
+        vector<const uint8_t*> data(k);
+        vector<uint8_t*> parity(r);
+        vector<uint8_t*> blocks(k + r);
+        for (int i = 0; i < k + r; ++i) blocks[i] = &matrix[i * block_size];
+        for (int i = 0; i < k; ++i) data[i] = blocks[i];
+        for (int i = 0; i < r; ++i) parity[i] = blocks[k + i];
+
+        const string kr = num(k) + "+" + num(r);
+        suite.run("fec/encode", {{"k", num(k)}, {"r", num(r)}, {"block_size", num(block_size)}},
+                  static_cast<double>(k * block_size), [&] {
+            coder.encode(data.data(), parity.data(), block_size);
+            keep(matrix);
+        });
+        coder.encode(data.data(), parity.data(), block_size);
+
+        // Worst case: the lost blocks are data blocks, so every erasure has to be rebuilt.
+        // Decoding only rewrites the missing blocks, so repeated runs need no reset.
+        const vector<uint8_t> original(matrix.begin(), matrix.begin() + k * block_size);
+        for (int erasures = 0; erasures <= r; ++erasures) {
+            uint64_t mask = (k + r == 64) ? ~0ull : (1ull << (k + r)) - 1;
+            for (int e = 0; e < erasures; ++e) mask &= ~(1ull << e);
+            if (!coder.decode_in_place(blocks.data(), mask, block_size) ||
+                !equal(original.begin(), original.end(), matrix.begin()))
+                throw runtime_error("FEC decode check failed for " + kr);
+
+            suite.run("fec/decode_in_place",
+                      {{"k", num(k)}, {"r", num(r)}, {"block_size", num(block_size)}, {"erasures", num(erasures)}},
+                      static_cast<double>(k * block_size), [&] {
+                bool ok = coder.decode_in_place(blocks.data(), mask, block_size);
+                keep(ok);
+            });
+        }
+    }
+}
+
+// Packets of FRAMES encoded frames with loss, duplication and local reordering applied; frame
+// ids are rebased on every pass so the collector always sees new frames
+struct CollectorTrace {
+    vector<vector<uint8_t>> buffers;
+    vector<PacketView> packets;
+    size_t frames = 0;
+};
+
+CollectorTrace make_trace(mt19937& rng, size_t frames, size_t frame_size, int k, int r,
+                          double loss, double duplicate, size_t reorder_window) {
+    CollectorTrace trace;
+    trace.frames = frames;
+    ErasureCoder coder(k, r);
+    uniform_real_distribution<double> chance(0.0, 1.0);
+
+    for (size_t f = 0; f < frames; ++f) {
+        FecLayout layout = plan_fec_groups(frame_size, k, r, 1000, 1024);
+        const size_t bs = layout.block_size;
+        const int groups = layout.group_count;
+        trace.buffers.emplace_back(static_cast<size_t>(groups) * (k + r) * bs, 0);
+        vector<uint8_t>& buffer = trace.buffers.back();
+        for (size_t i = 0; i < frame_size; ++i) buffer[i] = static_cast<uint8_t>(rng());
+
+        vector<const uint8_t*> data(groups * k);
+        vector<uint8_t*> parity(groups * r);
+        for (int i = 0; i < groups * k; ++i) data[i] = &buffer[i * bs];
+        for (int i = 0; i < groups * r; ++i) parity[i] = &buffer[(groups * k + i) * bs];
+        for (int g = 0; g < groups; ++g) coder.encode(&data[g * k], &parity[g * r], bs);
+
+        // Same interleaving as the sender: block index major, group minor
+        const size_t first = trace.packets.size();
+        for (int idx = 0; idx < k + r; ++idx) {
+            for (int g = 0; g < groups; ++g) {
+                if (chance(rng) < loss) continue;
+                PacketView pkt;
+                pkt.k = static_cast<uint8_t>(k);
+                pkt.r = static_cast<uint8_t>(r);
+                pkt.block_index = static_cast<uint8_t>(idx);
+                pkt.group_index = static_cast<uint16_t>(g);
+                pkt.block_size = static_cast<uint16_t>(bs);
+                pkt.frame_id = static_cast<uint32_t>(f);
+                pkt.frame_length = static_cast<uint32_t>(frame_size);
+                pkt.payload = idx < k ? data[g * k + idx] : parity[g * r + (idx - k)];
+                pkt.payload_size = bs;
+                trace.packets.push_back(pkt);
+                if (chance(rng) < duplicate) trace.packets.push_back(pkt);
+            }
+        }
+        if (reorder_window > 1) {
+            for (size_t i = first; i < trace.packets.size(); i += reorder_window)
+                shuffle(trace.packets.begin() + i,
+                        trace.packets.begin() + min(trace.packets.size(), i + reorder_window), rng);
+        }
+    }
+    return trace;
+}
+
+void bench_collector(Suite& suite, mt19937& rng) {
+    struct Scenario {
+        const char* name;
+        double loss;
+        double duplicate;
+        size_t reorder_window;
+    };
+    const Scenario scenarios[] = {
+        {"in_order", 0.0, 0.0, 1},
+        {"reorder", 0.0, 0.0, 32},
+        {"reorder_duplicate", 0.0, 0.2, 32},
+        {"loss_reorder_duplicate", 0.05, 0.2, 32},
+    };
+    const size_t frame_size = 30000;
+    const int k = 8, r = 4;
+
+    for (const Scenario& s : scenarios) {
+        CollectorTrace trace = make_trace(rng, 64, frame_size, k, r, s.loss, s.duplicate, s.reorder_window);
+        uint64_t delivered = 0;
+        SmartFrameCollector collector([&](const uint8_t* data, size_t size) {
+            keep(data);
+            delivered += size > 0;
+        }, k, r);
+
+        // One op is one packet; the flush after each frame is what the receive loop does
+        uint32_t base = 0;
+        size_t next = 0;
+        suite.run("collector/handle",
+                  {{"scenario", json_string(s.name)}, {"frame_size", num(frame_size)}, {"k", num(k)}, {"r", num(r)},
+                   {"loss", num(s.loss)}, {"duplicate", num(s.duplicate)}, {"reorder_window", num(s.reorder_window)}},
+                  0.0, [&] {
+            PacketView pkt = trace.packets[next];
+            pkt.frame_id += base;
+            collector.handle(pkt);
+            if (++next == trace.packets.size()) {
+                next = 0;
+                base += static_cast<uint32_t>(trace.frames);
+                collector.flush_expired_frames();
+            }
+        });
+        // A trace the collector cannot assemble would time only the rejection path
+        if (delivered == 0)
+            throw runtime_error(string("collector delivered no frames in scenario ") + s.name);
+    }
+}
+
+void bench_scheduler(Suite& suite) {
+    for (size_t count : {2, 4, 8}) {
+        vector<PathStats> paths;
+        for (size_t i = 0; i < count; ++i)
+            paths.emplace_back("127.0.0.1", 47000 + static_cast<int>(i), 10.0 + 15.0 * i, 0.01 * i);
+        WeightedScheduler scheduler(paths);
+        suite.run("scheduler/select_path", {{"paths", num(count)}}, 0.0, [&] {
+            PathStats chosen = scheduler.select_path();
+            keep(chosen);
+        });
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            string arg = argv[i];
+            if (i + 1 >= argc) throw invalid_argument(arg + " needs a value");
+            if (arg == "--filter") options.filter = argv[++i];
+            else if (arg == "--min-time") options.min_time_s = stod(argv[++i]);
+            else if (arg == "--out") options.out = argv[++i];
+            else throw invalid_argument("unknown option " + arg);
+        }
+    } catch (const exception& e) {
+        cerr << e.what() << endl
+             << "Usage: " << argv[0] << " [--filter substring] [--min-time s] [--out file.json]" << endl;
+        return 1;
+    }
+
+    // Fixed seed: every run measures the same inputs
+    mt19937 rng(20240601);
+    Suite suite(options);
+    // The engine logs to cout ([FEC], [scheduler]); keep stdout for the JSON
+    streambuf* stdout_buf = cout.rdbuf(cerr.rdbuf());
+    try {
+        bench_packets(suite, rng);
+        bench_slicing(suite, rng);
+        bench_fec(suite, rng);
+        bench_collector(suite, rng);
+        bench_scheduler(suite);
+    } catch (const exception& e) {
+        cerr << "[MICROBENCH] " << e.what() << endl;
+        return 1;
+    }
+    cout.rdbuf(stdout_buf);
+
+    const string json = suite.json();
+    if (options.out.empty()) {
+        cout << json;
+    } else {
+        FILE* file = fopen(options.out.c_str(), "w");
+        if (!file || fwrite(json.data(), 1, json.size(), file) != json.size()) {
+            cerr << "[MICROBENCH] Cannot write " << options.out << endl;
+            if (file) fclose(file);
+            return 1;
+        }
+        fclose(file);
+        cerr << "Results written to " << options.out << endl;
+    }
+    return 0;
+}
@@ -1,11 +1,27 @@
 #pragma once
 
+#include "scheduler.hpp"
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <cstddef>
 
-// Başlatma: hedef IP ve port listesi
-void init_chunk_dispatcher(const std::string& target_ip, const std::vector<int>& ports);
+class UdpSender;
 
-// Raw bir UDP chunk verisini uygun porta yönlendir
-void dispatch_chunk(const uint8_t* data, size_t size);
+// Raw UDP chunk'larını ağırlıklı scheduler'ın seçtiği porta yönlendirir.
+// sender açık olmalı ve dispatcher'dan uzun yaşamalı
+class ChunkDispatcher {
+public:
+    ChunkDispatcher(UdpSender& sender, const std::string& target_ip, const std::vector<int>& ports);
+
+    // Raw bir UDP chunk verisini uygun porta yönlendir
+    void dispatch(const uint8_t* data, size_t size);
+
+    // Yol ölçümleri değişince ağırlıkları yeniler
+    void update_paths(const std::vector<PathStats>& paths) { scheduler_.update_metrics(paths); }
+
+private:
+    UdpSender& sender_;
+    std::string target_ip_;
+    WeightedScheduler scheduler_;
+};
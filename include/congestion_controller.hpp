@@ -0,0 +1,109 @@
+#pragma once
+
+#include "feedback.hpp"
+#include <deque>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+// Bir alıcı raporundan çıkarılan girdi. Zamanlar çağıranın verdiği saatten gelir
+// (Clock::now() okunmaz), böylece denetleyici simülasyonda deterministik çalışır.
+struct CongestionFeedback {
+    int64_t now_ms = 0;                       // rapor geldiğinde gönderici saati
+    const ArrivalSample* arrivals = nullptr;  // gönderim grubu başına gönderim/varış zamanı
+    size_t arrival_count = 0;
+    double loss_fraction = -1.0;              // son rapor aralığında kayıp oranı; bilinmiyorsa < 0
+    double rtt_ms = -1.0;                     // bilinmiyorsa < 0
+    double received_bps = -1.0;               // alıcıya ulaşan hız; bilinmiyorsa < 0
+};
+
+// Gönderici hız denetleyicisi: her geri bildirim aralığında beslenir, encoder hedefini verir
+class CongestionController {
+public:
+    virtual ~CongestionController() = default;
+    virtual void on_feedback(const CongestionFeedback& feedback) = 0;
+    virtual int target_bitrate() const = 0;
+};
+
+enum class BandwidthUsage { NORMAL, UNDERUSING, OVERUSING };
+
+// Tek yönlü gecikme değişiminin eğilimi: ardışık gruplar arasında
+// (varış farkı - gönderim farkı) birikir, üstel yumuşatılır ve son WINDOW grubun
+// doğrusal regresyon eğimi uyarlanır bir eşikle karşılaştırılır (kuyruk doluyorsa eğim > 0).
+class TrendlineEstimator {
+public:
+    static constexpr size_t WINDOW = 20;
+    static constexpr double SMOOTHING = 0.9;
+    static constexpr double GAIN = 4.0;
+    static constexpr double OVERUSE_TIME_MS = 10.0;
+
+    // Bir grubun gönderim ve varış zamanı (ms; iki saat birbirinden bağımsız)
+    void update(double send_ms, double arrival_ms);
+
+    BandwidthUsage state() const { return state_; }
+    double modified_trend() const { return modified_trend_; }
+    double threshold() const { return threshold_; }
+
+private:
+    void detect(double trend, double send_delta_ms, double arrival_ms);
+    void update_threshold(double modified_trend, double now_ms);
+
+    bool have_previous_ = false;
+    double previous_send_ms_ = 0.0;
+    double previous_arrival_ms_ = 0.0;
+    double first_arrival_ms_ = -1.0;
+
+    int num_deltas_ = 0;
+    double accumulated_delay_ = 0.0;
+    double smoothed_delay_ = 0.0;
+    std::deque<std::pair<double, double>> history_;   // (varış zamanı, yumuşatılmış gecikme)
+
+    double previous_trend_ = 0.0;
+    double modified_trend_ = 0.0;
+    double threshold_ = 12.5;
+    double last_threshold_update_ms_ = -1.0;
+    double time_over_using_ms_ = -1.0;
+    int overuse_count_ = 0;
+    BandwidthUsage state_ = BandwidthUsage::NORMAL;
+};
+
+// Gecikme eğimi + kayıp tabanlı AIMD:
+//  - aşırı kullanım → alıcıya ulaşan hızın %85'ine in
+//  - normal → bilinen kapasiteden uzaksa çarpımsal (%8/s), yakınsa RTT başına bir paket artış
+//  - düşük kullanım → bekle (kuyruk boşalıyor)
+//  - kayıp > %10 → hedef * (1 - kayıp/2); %2..%10 arası artış yok
+class DelayGradientController : public CongestionController {
+public:
+    DelayGradientController(int initial_bps, int min_bps, int max_bps);
+
+    void on_feedback(const CongestionFeedback& feedback) override;
+    int target_bitrate() const override { return static_cast<int>(target_bps_); }
+
+    BandwidthUsage usage() const { return trendline_.state(); }
+
+    static constexpr double DECREASE_FACTOR = 0.85;
+    static constexpr double INCREASE_PER_SECOND = 1.08;
+    static constexpr double PACKET_BITS = 1200 * 8;   // ek artış adımı: tepki süresi başına bir paket
+    static constexpr double LOSS_HIGH = 0.10;
+    static constexpr double LOSS_LOW = 0.02;
+    static constexpr int LOSS_BACKOFF_INTERVAL_MS = 300;   // + RTT, kayıp düşüşleri arasında
+    // Kayıp oranı raporlar boyunca üstel ortalanır: düşük hızda bir aralıkta birkaç paket
+    // olur ve tek bir kayıp %10'u aşar
+    static constexpr double LOSS_SMOOTHING = 0.2;
+
+private:
+    enum class RateState { HOLD, INCREASE, DECREASE };
+
+    void update_delay_based(const CongestionFeedback& feedback, double dt_ms);
+
+    TrendlineEstimator trendline_;
+    RateState rate_state_ = RateState::INCREASE;
+    double target_bps_;
+    double min_bps_;
+    double max_bps_;
+    double link_capacity_bps_ = -1.0;   // son düşüşlerde ölçülen hızın ortalaması; bilinmiyorsa < 0
+    int64_t last_update_ms_ = -1;
+    int64_t last_decrease_ms_ = -1;
+    int64_t last_loss_backoff_ms_ = -1;
+    double loss_fraction_ = -1.0;       // üstel ortalama; henüz rapor yoksa < 0
+};
@@ -16,6 +16,7 @@ public:
 
     // Yeni frame decode edildiğinde true döner
     bool decode(const std::vector<uint8_t>& encoded_data, cv::Mat& output_frame);
+    bool decode(const uint8_t* data, size_t size, cv::Mat& output_frame);
 
 private:
     AVCodec* codec = nullptr;
@@ -1,7 +1,15 @@
 #pragma once
 #include <vector>
 #include <cstdint>
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
 
+// Reed-Solomon (Vandermonde, Jerasure ile aynı matris) kodlayıcı.
+// Çarpma-toplama işlemleri gf256 SIMD çekirdekleriyle yapılır; yalnızca w = 8 ve k + r <= 64 desteklenir.
+// Jerasure ile bit bit aynılığı tests/erasure_coder_test.cpp denetler.
 class ErasureCoder {
 public:
     ErasureCoder(int k, int r, int w = 8);
@@ -10,11 +18,38 @@ public:
     void encode(const std::vector<std::vector<uint8_t>>& k_chunks,
                 std::vector<std::vector<uint8_t>>& out_blocks); // size = k+r
 
+    // Kopyasız kodlama: data[0..k) okunur, parity[0..r) yazılır
+    void encode(const uint8_t* const* data, uint8_t* const* parity, size_t block_size);
+
     bool decode(const std::vector<std::vector<uint8_t>>& blocks,
                 const std::vector<bool>& received,
                 std::vector<uint8_t>& recovered_data);
+
+    // Çağıranın belleğinde yerinde çözme: blocks[i] → blok i (k+r işaretçi).
+    // received_mask'in i. biti blok i'nin geldiğini gösterir. Yalnızca eksik veri blokları
+    // yazılır; kayıpsız durumda hiçbir şey kopyalanmaz. Veri blokları bitişikse sonuç
+    // doğrudan blocks[0]'dan başlayan k * block_size baytlık frame'dir.
+    bool decode_in_place(uint8_t* const* blocks, uint64_t received_mask, size_t block_size);
+
+    // Ters çözme matrisi önbelleği (alınan blok bit maskesine göre LRU)
+    uint64_t cache_hits() const { return cache_hits_; }
+    uint64_t cache_misses() const { return cache_misses_; }
+
+    static constexpr size_t DECODE_CACHE_CAPACITY = 64;
+    static constexpr int MAX_BLOCKS = 64;  // k + r üst sınırı (bit maskesi)
 private:
+    // Maskedeki k satır için ters matrisi önbellekten verir, yoksa hesaplayıp ekler
+    bool decoding_matrix(uint64_t row_mask, const int* rows, uint8_t* inv);
+
     int k_, r_, w_;
     int* matrix_;
+    std::vector<uint8_t> coding_;  // r x k katsayı, matrix_ ile aynı
+
+    using CacheEntry = std::pair<uint64_t, std::vector<uint8_t>>;
+    std::list<CacheEntry> cache_lru_;  // en yeni başta
+    std::unordered_map<uint64_t, std::list<CacheEntry>::iterator> cache_index_;
+    std::mutex cache_mutex_;
+    std::atomic<uint64_t> cache_hits_{0};
+    std::atomic<uint64_t> cache_misses_{0};
 };
 
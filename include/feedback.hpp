@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Alıcı → gönderici geri bildirim paketleri. İlk bayt paket türüdür; medya paketlerinin
+// ilk baytı PACKET_VERSION (2) olduğundan aynı soketlerde karışmazlar.
+constexpr uint8_t FEEDBACK_NACK = 0x81;
+constexpr uint8_t FEEDBACK_REPORT = 0x82;
+
+// NACK paketi (little endian):
+// [0]      type          (FEEDBACK_NACK)
+// [1]      entry_count   (1 byte, en fazla MAX_NACK_ENTRIES)
+// [2-3]    reserved
+// [4...]   entry_count x NackEntry (16 byte)
+constexpr std::size_t NACK_HEADER_SIZE = 4;
+constexpr std::size_t MAX_NACK_ENTRIES = 64;  // 4 + 64 * 16 = 1028 bayt, tek datagram
+
+// Bir grubun yeniden istenen blokları.
+// budget_ms: alıcının bu frame için oynatma deadline'ına kalan süre; gönderici
+// RTT bu süreye sığmıyorsa yeniden göndermez.
+struct alignas(8) NackEntry {
+    uint32_t frame_id = 0;
+    uint16_t group_index = 0;
+    uint16_t budget_ms = 0;
+    uint64_t missing_mask = 0;   // bit i → grup bloğu i isteniyor
+};
+
+static_assert(sizeof(NackEntry) == 16, "NackEntry must match the wire layout");
+
+// Datagram'ın geri bildirim türü; geri bildirim değilse 0
+uint8_t feedback_type(const uint8_t* data, size_t len);
+
+// out en az NACK_HEADER_SIZE + count * sizeof(NackEntry) bayt olmalı; yazılan bayt sayısını döner
+size_t write_nack(const NackEntry* entries, size_t count, uint8_t* out);
+bool parse_nack(const uint8_t* data, size_t len, std::vector<NackEntry>& entries);
+
+// Periyodik alıcı raporu (little endian):
+// [0]      type          (FEEDBACK_REPORT)
+// [1]      path_count    (en fazla MAX_REPORT_PATHS)
+// [2]      arrival_count (en fazla MAX_REPORT_ARRIVALS)
+// [3]      reserved
+// [4-35]   ReceiverReport
+// [36...]  path_count x ReportPath (8 byte), ardından arrival_count x ArrivalSample (16 byte)
+constexpr std::size_t REPORT_HEADER_SIZE = 4;
+constexpr std::size_t MAX_REPORT_PATHS = 32;
+constexpr std::size_t MAX_REPORT_ARRIVALS = 32;
+
+// RTT = şimdi - echo_timestamp_us - hold_us (yalnızca gönderici saati kullanılır).
+// frame_loss_mask: bit i → played_frame_id - i oynatılamadı (geç kaldı ya da kurtarılamadı)
+struct alignas(8) ReceiverReport {
+    uint32_t highest_frame_id = 0;   // görülen en yeni frame
+    uint32_t played_frame_id = 0;    // oynatma sırasında son karara bağlanan frame
+    int64_t echo_timestamp_us = 0;   // son medya paketinin gönderici timestamp'i
+    uint32_t hold_us = 0;            // o paketin alınmasından rapora kadar geçen süre
+    uint16_t echo_port = 0;          // o paketin geldiği port
+    uint16_t reserved = 0;
+    uint64_t frame_loss_mask = 0;
+};
+
+// Alıcı portu başına toplam alınan datagram (32 bit, taşarak sayar)
+struct ReportPath {
+    uint16_t port = 0;
+    uint16_t reserved = 0;
+    uint32_t received = 0;
+};
+
+// Bir gönderim grubunun (aynı anda yollanan paketler) son paketi: gönderici timestamp'i ve
+// alıcı saatinde varış zamanı. Saatler farklıdır; yalnızca ardışık farkları anlamlıdır.
+struct alignas(8) ArrivalSample {
+    int64_t send_us = 0;
+    int64_t arrival_us = 0;
+};
+
+static_assert(sizeof(ReceiverReport) == 32, "ReceiverReport must match the wire layout");
+static_assert(sizeof(ReportPath) == 8, "ReportPath must match the wire layout");
+static_assert(sizeof(ArrivalSample) == 16, "ArrivalSample must match the wire layout");
+
+// out en az REPORT_HEADER_SIZE + sizeof(ReceiverReport) + paths * sizeof(ReportPath)
+// + arrivals * sizeof(ArrivalSample) bayt olmalı
+size_t write_receiver_report(const ReceiverReport& report,
+                             const ReportPath* paths, size_t path_count,
+                             const ArrivalSample* arrivals, size_t arrival_count, uint8_t* out);
+bool parse_receiver_report(const uint8_t* data, size_t len, ReceiverReport& report,
+                           std::vector<ReportPath>& paths, std::vector<ArrivalSample>& arrivals);
+
+// Alıcı tarafı: paketleri gönderim zamanına göre gruplar (GROUP_SPAN_US içinde gönderilenler
+// tek grup) ve tamamlanan grupları rapora kadar biriktirir. Yeniden gönderimler kendi gruplarını kurar.
+class ArrivalGroups {
+public:
+    static constexpr int64_t GROUP_SPAN_US = 5000;
+
+    void on_packet(int64_t send_us, int64_t arrival_us);
+    // Biriken grupları out'a taşır (en fazla max, en yeniler); yazılan sayıyı döner
+    size_t take(ArrivalSample* out, size_t max);
+
+private:
+    std::vector<ArrivalSample> done_;
+    ArrivalSample current_;
+    int64_t group_start_us_ = 0;
+    bool have_group_ = false;
+};
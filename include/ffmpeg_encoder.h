@@ -15,8 +15,10 @@ public:
     FFmpegEncoder(int width, int height, int fps, int bitrate);
     ~FFmpegEncoder();
 
-    // BGR Mat -> H264 encode edilmiş veri
-    bool encodeFrame(const cv::Mat& bgrFrame, std::vector<uint8_t>& outEncodedData);
+    // BGR Mat (CV_8UC3) veya I420 Mat (CV_8UC1, sürekli, height*3/2 satır) -> H264 encode edilmiş veri.
+    // I420 düzlemleri renk dönüşümü olmadan, tek kopyayla encoder'ın havuzundaki bir frame'e alınır.
+    // Çağıranın belleği çağrı dönünce serbesttir (codec frame'e referans tutsa bile)
+    bool encodeFrame(const cv::Mat& inputFrame, std::vector<uint8_t>& outEncodedData);
 
     // Dinamik bitrate ayarı (kbps)
     void setBitrate(int bitrate);
@@ -28,13 +30,16 @@ private:
 
     const AVCodec* codec = nullptr;
     AVCodecContext* codecContext = nullptr;
-    AVFrame* frame = nullptr;
+    AVFrame* frame = nullptr;            // her çağrıda havuzdan yeni bir tampona bağlanır
+    AVBufferPool* framePool = nullptr;   // codec referansı bırakınca tampon havuza döner
     AVPacket* pkt = nullptr;
     SwsContext* swsCtx = nullptr;
 
     void initEncoder();
     void cleanup();
+    // frame'i havuzdan alınan boş bir YUV420P tampona bağlar
+    bool acquireInputFrame();
     
     // Calculate scene complexity for dynamic compression
-    double calculateSceneComplexity(const cv::Mat& bgrFrame);
+    double calculateSceneComplexity(const cv::Mat& gray);
 };
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Frame piksel düzeni:
+//  BGR24 → CV_8UC3, height × width
+//  I420  → CV_8UC1, sürekli, (height * 3/2) × width: Y düzlemi, ardından U ve V (width/2 adımlı)
+enum class FrameFormat { BGR24, I420 };
+
+// Gönderici için frame kaynağı (kamera, sentetik desen, dosya). read() beklemez ya da kaynağın
+// kendi hızında bekler; hedef fps'e göre tempo yakalama thread'inin işidir.
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    // Bir sonraki frame; false → frame yok (kamera hatası vb.), çağıran biraz bekleyip yeniden dener.
+    // frame'in tamponu yeniden kullanılabilir; bazı kaynaklar kopya yerine kendi belleklerine
+    // bakan bir başlık verir (kaynak yaşadıkça geçerli, salt okunur).
+    virtual bool read(cv::Mat& frame) = 0;
+
+    virtual FrameFormat format() const = 0;
+    virtual int width() const = 0;
+    virtual int height() const = 0;
+    virtual int fps() const = 0;
+    virtual std::string describe() const = 0;
+
+    // false: read() salt okunur belleğe bakan başlık verir, frame'e yazmadan önce kopyalanmalı
+    virtual bool frames_writable() const { return true; }
+};
+
+// V4L2 kamera; açılamazsa std::runtime_error
+class CameraSource : public FrameSource {
+public:
+    CameraSource(int device, int width, int height, int fps);
+
+    bool read(cv::Mat& frame) override { return capture_.read(frame) && !frame.empty(); }
+    FrameFormat format() const override { return FrameFormat::BGR24; }
+    int width() const override { return width_; }
+    int height() const override { return height_; }
+    int fps() const override { return fps_; }
+    std::string describe() const override;
+
+private:
+    cv::VideoCapture capture_;
+    int device_;
+    int width_, height_, fps_;
+};
+
+// Deterministik test deseni (I420): kayan çapraz rampa, renk düzlemlerinde yatay/dikey
+// gradyanlar, zıplayan bir kare ve gürültü. Aynı (boyut, complexity, seed) her makinede aynı
+// frame dizisini üretir. complexity 0..1: rampa sıklığı ve gürültü genliği (encoder yükü) artar.
+class SyntheticSource : public FrameSource {
+public:
+    SyntheticSource(int width, int height, int fps, double complexity, uint32_t seed = 1);
+
+    bool read(cv::Mat& frame) override;
+    FrameFormat format() const override { return FrameFormat::I420; }
+    int width() const override { return width_; }
+    int height() const override { return height_; }
+    int fps() const override { return fps_; }
+    std::string describe() const override;
+
+private:
+    int width_, height_, fps_;
+    double complexity_;
+    uint32_t seed_;
+    uint64_t frame_index_ = 0;
+};
+
+// Y4M (4:2:0) ya da ham I420 .yuv dosyası. Dosya bir kez mmap edilir; read() kopya yapmaz,
+// eşlenmiş frame'e bakan salt okunur bir Mat başlığı verir. Sona gelince başa sarar (loop).
+// Açma/format hatalarında std::runtime_error.
+class FileSource : public FrameSource {
+public:
+    // Y4M boyut ve fps'i başlıktan okur; .yuv için width/height/fps verilmelidir
+    FileSource(const std::string& path, int width, int height, int fps, bool loop = true);
+    ~FileSource() override;
+
+    FileSource(const FileSource&) = delete;
+    FileSource& operator=(const FileSource&) = delete;
+
+    bool read(cv::Mat& frame) override;
+    FrameFormat format() const override { return FrameFormat::I420; }
+    int width() const override { return width_; }
+    int height() const override { return height_; }
+    int fps() const override { return fps_; }
+    std::string describe() const override;
+    bool frames_writable() const override { return false; }
+
+    size_t frame_count() const { return frames_.size(); }
+
+private:
+    void parse_y4m();
+    void index_raw();
+
+    std::string path_;
+    int width_, height_, fps_;
+    bool loop_;
+    const uint8_t* map_ = nullptr;
+    size_t map_size_ = 0;
+    size_t frame_size_ = 0;
+    std::vector<size_t> frames_;   // her frame'in piksel verisinin dosya içindeki konumu
+    size_t next_ = 0;
+};
+
+// Kaynak tanımı:
+//   camera[:N]                 → /dev/videoN (varsayılan 0)
+//   synthetic[:complexity]     → SyntheticSource (varsayılan 0.5)
+//   <dosya>.y4m                → FileSource
+//   <dosya>.yuv                → FileSource, ham I420 (width/height/fps buradan)
+// Geçersiz tanımda std::runtime_error
+std::unique_ptr<FrameSource> open_frame_source(const std::string& spec, int width, int height, int fps);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// GF(2^8) aritmetiği, polinom 0x11D (Jerasure/gf-complete w=8 varsayılanı ile aynı alan)
+// Bölge fonksiyonları split-nibble tablo araması kullanır:
+// çalışma zamanında AVX-512BW → AVX2 → SSSE3 → skaler arasından seçim yapılır.
+
+uint8_t gf256_mul(uint8_t a, uint8_t b);
+uint8_t gf256_inv(uint8_t a);  // a != 0
+
+// dst[i] ^= c * src[i]
+void gf256_mul_add_region(uint8_t c, const uint8_t* src, uint8_t* dst, size_t len);
+
+// dst[i] = c * src[i]
+void gf256_mul_region(uint8_t c, const uint8_t* src, uint8_t* dst, size_t len);
+
+// n x n matris tersi (satır öncelikli). Tekil ise false
+bool gf256_invert_matrix(const uint8_t* in, uint8_t* out, int n);
+
+// Seçilen çekirdeğin adı: "avx512", "avx2", "ssse3" veya "scalar"
+const char* gf256_backend();
+
+// Çekirdeği adla seçer (testler ve benchmark'lar için); CPU desteklemiyorsa false döner ve
+// seçim değişmez. Başka bir thread bölge fonksiyonlarını çağırırken kullanılmamalı
+bool gf256_select_backend(const char* name);
@@ -5,6 +5,8 @@
 #include <chrono>
 #include <mutex>
 #include <vector>
+#include <cstdint>
+#include "timer_wheel.hpp"
 
 class LossTracker {
 public:
@@ -12,14 +14,16 @@ public:
 
     void ping_sent(int port);         // Zamanı kaydet
     void pong_received(int port);     // Cevap alındı → başarısızlıktan çıkar
-    void update();                    // Zamanı aşan portları "kaybedilmiş" olarak say
+    void update();                    // Zamanı aşan portları "kaybedilmiş" olarak say (yalnızca süresi dolanlar işlenir)
 
     int get_loss_count(int port) const;
     std::vector<int> get_high_loss_ports(int threshold = 3) const;
     
     // Enhanced packet loss tracking
     void packetSent(int port);
+    void packetsSent(int port, uint64_t count);
     void packetReceived(int port);
+    void packetsReceived(int port, uint64_t count);   // alıcı raporundaki artış
     double getLossRate() const;
     double getLossRate(int port) const;
     std::vector<int> getHighLossPorts(double threshold = 0.05) const;
@@ -29,6 +33,7 @@ private:
         std::chrono::steady_clock::time_point sent_time;
         int loss_count = 0;
         bool waiting_response = false;
+        TimerWheel::TimerId timer = 0;
     };
     
     struct PortStats {
@@ -42,6 +47,7 @@ private:
     std::unordered_map<int, PingInfo> ping_map_;
     std::unordered_map<int, PortStats> port_stats_;
     int timeout_ms_;
+    TimerWheel ping_timeouts_;    // tag = port
 };
 
 #endif // NOVAENGINE_LOSS_TRACKER_HPP
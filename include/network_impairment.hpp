@@ -0,0 +1,138 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+#include <netinet/in.h>
+#include <sys/uio.h>
+
+// Gecikme sapmasının dağılımı (jitter_ms ölçeğinde)
+enum class DelayDistribution {
+    CONSTANT,   // sapma yok
+    UNIFORM,    // [-jitter, +jitter]
+    NORMAL,     // ortalama 0, standart sapma jitter
+    PARETO      // yalnızca pozitif, ağır kuyruklu (α = 2.5, ortalama ≈ 0.67 · jitter)
+};
+
+// Yol başına bozulma ayarları; varsayılanlar paketi olduğu gibi geçirir.
+// Sıra: kayıp → bant genişliği kuyruğu → gecikme → sıra bozma → çoğaltma
+struct ImpairmentConfig {
+    // Gilbert–Elliott kanalı: her pakette önce durum geçişi, sonra o durumun kayıp olasılığı.
+    // Bağımsız kayıp için loss_good yeterli; patlama uzunluğu ortalaması 1 / bad_to_good
+    double good_to_bad = 0.0;
+    double bad_to_good = 1.0;
+    double loss_good = 0.0;
+    double loss_bad = 1.0;
+
+    // Gecikme: delay_ms + dağılımdan sapma, negatife inmez
+    double delay_ms = 0.0;
+    double jitter_ms = 0.0;
+    DelayDistribution distribution = DelayDistribution::UNIFORM;
+
+    // Sıra bozma: paket bu olasılıkla reorder_gap_ms fazladan bekler, arkasındakiler öne geçer.
+    // Bunun dışında yol sırası korunur (jitter tek başına sıra bozmaz)
+    double reorder = 0.0;
+    double reorder_gap_ms = 10.0;
+
+    // Çoğaltma: paketin ikinci kopyası hemen arkasından gelir
+    double duplicate = 0.0;
+
+    // Token bucket bant sınırı (bit/s, başlık + payload); 0 → sınırsız.
+    // Kuyruk queue_limit_bytes'ı aşan paketler atılır (tail drop)
+    int64_t rate_bps = 0;
+    size_t burst_bytes = 3000;
+    size_t queue_limit_bytes = 64 * 1024;
+};
+
+struct ImpairmentStats {
+    uint64_t submitted = 0;
+    uint64_t lost = 0;           // Gilbert–Elliott kaybı
+    uint64_t queue_drops = 0;    // bant sınırı kuyruğu taştı
+    uint64_t reordered = 0;
+    uint64_t duplicated = 0;
+    uint64_t delivered = 0;      // soketten çıkanlar (kopyalar dahil)
+    uint64_t send_errors = 0;
+};
+
+// Gönderici ile çekirdek arasına giren ağ emülatörü (root ve netem gerektirmez).
+// submit() datagram'ı kopyalar, kaderini (kayıp, kuyruk, gecikme...) hemen belirler ve bırakma
+// zamanına kadar kendi thread'inde bekletir; sonra sink'e (varsayılan: sendto) verir.
+// Her yolun kendi RNG'si vardır (seed + yol): aynı seed ve aynı gönderim dizisi aynı sonucu verir.
+class NetworkImpairment {
+public:
+    // Bırakılan datagram'ı gönderir; false → gönderilemedi (send_errors)
+    using Sink = std::function<bool(int fd, const sockaddr_in& to, const uint8_t* data, size_t len)>;
+
+    // paths[i] → yol i; fazla yollar son ayarı kullanır. paths boşsa std::runtime_error
+    NetworkImpairment(std::vector<ImpairmentConfig> paths, uint64_t seed, Sink sink = {});
+    ~NetworkImpairment();
+
+    NetworkImpairment(const NetworkImpairment&) = delete;
+    NetworkImpairment& operator=(const NetworkImpairment&) = delete;
+
+    // Bekleyenleri bırakmadan thread'i durdurur; soketler kapanmadan önce çağrılmalı
+    void stop();
+
+    // iov içeriği çağrı süresince okunur ve kopyalanır
+    void submit(size_t path, int fd, const sockaddr_in& to, const iovec* iov, int iov_count);
+
+    // Çalışırken ayar değiştirmek için (tarama); kanal durumu ve kuyruk korunur
+    void set_config(size_t path, const ImpairmentConfig& config);
+
+    ImpairmentStats stats(size_t path) const;
+    size_t path_count() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct PathState {
+        ImpairmentConfig config;
+        std::mt19937_64 rng;
+        bool bad = false;               // Gilbert–Elliott durumu
+        int64_t link_free_us = 0;       // bant sınırı: sıradaki paketin hatta çıkabileceği an
+        int64_t last_release_us = 0;    // sıra korunurken en son bırakma anı
+        ImpairmentStats stats;
+    };
+
+    struct Pending {
+        int64_t release_us;
+        uint64_t order;                 // aynı anda bırakılacaklarda geliş sırası
+        size_t path;
+        int fd;
+        sockaddr_in to;
+        std::vector<uint8_t> data;
+    };
+
+    struct Later {
+        bool operator()(const Pending& a, const Pending& b) const {
+            return a.release_us != b.release_us ? a.release_us > b.release_us : a.order > b.order;
+        }
+    };
+
+    PathState& path_state(size_t path);
+    double uniform(PathState& state);
+    int64_t delay_us(PathState& state);
+    void schedule(size_t path, int64_t release_us, int fd, const sockaddr_in& to,
+                  const iovec* iov, int iov_count);
+    void run();
+
+    Sink sink_;
+    uint64_t seed_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::vector<PathState> paths_;
+    std::priority_queue<Pending, std::vector<Pending>, Later> pending_;
+    std::vector<std::vector<uint8_t>> free_buffers_;
+    uint64_t next_order_ = 0;
+    bool stop_ = false;
+
+    std::thread thread_;
+};
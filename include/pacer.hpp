@@ -0,0 +1,85 @@
+#pragma once
+
+#include "packet_parser.hpp"
+#include "udp_sender.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// FEC çıktısı ile soketler arasındaki token bucket pacer; gönderim kendi thread'inde yapılır.
+// Kova hedef hızla dolar ve en fazla BURST_US kadar kredi biriktirir; her paket kendi boyu kadar
+// token harcar. Kuyruk son enqueue'dan sonra max_delay içinde boşalmayacaksa hız buna yetecek
+// kadar yükseltilir, böylece büyük bir frame (ör. I-frame) tam bir frame aralığına yayılır.
+//
+// Paketler kopyalanmaz: payload'lar gönderilene kadar geçerli kalmalıdır. Payload'ın sahibi
+// tamponunu yeniden kullanmadan önce drop_frame() çağırır (ör. retransmit halkası bir slot'u
+// devretmeden önce). Timestamp gönderim anında yazılır, böylece kuyrukta geçen süre ağ
+// gecikmesi olarak görünmez.
+class Pacer {
+public:
+    static constexpr int64_t BURST_US = 1000;
+    static constexpr int64_t TXTIME_LOOKAHEAD_US = 2000;   // SO_TXTIME ile çekirdeğe erken verilen pencere
+    static constexpr size_t MAX_BATCH = 64;
+
+    // Paketler sender üzerinden gider (açık olmalı, pacer'dan uzun yaşamalı).
+    // kernel_pacing: SO_TXTIME denenir; açılamazsa kullanıcı alanında beklenerek gönderilir
+    Pacer(UdpSender& sender, const std::string& target_ip, const std::vector<int>& ports,
+          std::chrono::milliseconds max_delay, bool kernel_pacing);
+    ~Pacer();
+
+    // Thread'i durdurur (kuyrukta kalanlar gönderilmez); soketler kapatılmadan önce çağrılmalı
+    void stop();
+
+    Pacer(const Pacer&) = delete;
+    Pacer& operator=(const Pacer&) = delete;
+
+    // Yol başına tel hızı (başlık + payload bitleri / s)
+    void set_rate(int bits_per_second);
+    void set_max_delay(std::chrono::milliseconds max_delay);
+
+    // priority: yeniden gönderimler yeni frame'lerin önüne geçer
+    void enqueue(const std::vector<PacketView>& packets, bool priority = false);
+
+    // frame_id'nin kuyruktaki paketlerini atar ve gönderilmekte olan bir batch'te paketi
+    // varsa bitmesini bekler; döndükten sonra pacer o frame'in tamponlarına dokunmaz.
+    // Atılan paket sayısını döndürür
+    size_t drop_frame(uint32_t frame_id);
+    uint64_t dropped() const;
+
+    // Son çağrıdan beri gönderilenler (yol başına datagram, bayt); sayaçları sıfırlar
+    BatchSendResult take_sent();
+
+    size_t queued() const;
+    bool kernel_pacing() const { return use_txtime_; }
+
+private:
+    void run();
+
+    UdpSender& sender_;
+    const std::string target_ip_;
+    const std::vector<int> ports_;
+    bool use_txtime_ = false;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::deque<PacketView> priority_;
+    std::deque<PacketView> queue_;
+    size_t queued_bytes_ = 0;
+    int64_t rate_bps_ = 1000000;
+    int64_t max_delay_us_ = 33000;
+    int64_t drain_deadline_us_ = 0;   // son enqueue + max_delay: kuyruk bu ana kadar boşalır
+    BatchSendResult sent_;
+    uint64_t dropped_ = 0;
+    bool stop_ = false;
+
+    // Kilitsiz gönderilen batch; sending_ iken payload'ları okunuyor
+    std::vector<PacketView> in_flight_;
+    bool sending_ = false;
+    std::condition_variable sent_cv_;
+
+    std::thread thread_;
+};
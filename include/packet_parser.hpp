@@ -3,17 +3,60 @@
 #include <vector>
 #include <cstddef>    // <-- burada
 
-struct ChunkPacket {
-    uint16_t frame_id;
-    uint8_t chunk_id;
-    uint8_t total_chunks;
-    int64_t timestamp;  // Microsecond timestamp for RTT calculation
+constexpr uint8_t PACKET_VERSION = 2;
+constexpr std::size_t PACKET_HEADER_SIZE = 24;
+
+// Sabit yerleşimli v2 başlık (little endian). Bellek düzeni kablodaki düzenle aynıdır,
+// böylece başlık tek bir hizalı kopyayla okunur/yazılır:
+// [0]      version       (1 byte, PACKET_VERSION)
+// [1]      k             (1 byte, gruptaki veri bloğu sayısı)
+// [2]      r             (1 byte, gruptaki parity bloğu sayısı)
+// [3]      block_index   (1 byte, grup içi blok 0..k+r-1; < k veri, >= k parity)
+// [4-5]    group_index   (2 byte)
+// [6-7]    block_size    (2 byte, her bloğun payload boyu)
+// [8-11]   frame_id      (4 byte)
+// [12-15]  frame_length  (4 byte, dolgusuz orijinal frame boyu)
+// [16-23]  timestamp     (8 byte - int64_t, mikrosaniye)
+// [24...]  payload       (block_size bayt)
+// Grup sayısı: ceil(frame_length / (k * block_size))
+struct alignas(8) PacketHeader {
+    uint8_t version = PACKET_VERSION;
+    uint8_t k = 0;
+    uint8_t r = 0;
+    uint8_t block_index = 0;
+    uint16_t group_index = 0;
+    uint16_t block_size = 0;
+    uint32_t frame_id = 0;
+    uint32_t frame_length = 0;
+    int64_t timestamp = 0;  // Microsecond timestamp for RTT calculation
+
+    uint32_t group_count() const {
+        uint64_t group_bytes = static_cast<uint64_t>(k) * block_size;
+        return group_bytes ? static_cast<uint32_t>((frame_length + group_bytes - 1) / group_bytes) : 0;
+    }
+};
+
+static_assert(sizeof(PacketHeader) == PACKET_HEADER_SIZE, "PacketHeader must match the wire layout");
+
+struct ChunkPacket : PacketHeader {
     std::vector<uint8_t> payload;
 };
 
+// Sahiplenmeyen paket: başlık + başka bir tampondaki payload'a işaretçi (kopyasız gönderim için)
+struct PacketView : PacketHeader {
+    const uint8_t* payload = nullptr;
+    std::size_t payload_size = 0;
+};
+
+// Header → out[0..PACKET_HEADER_SIZE)
+void write_packet_header(const PacketHeader& hdr, uint8_t* out);
+
 // ChunkPacket → Byte array
 std::vector<uint8_t> serialize_packet(const ChunkPacket& pkt);
 
 // Byte array → ChunkPacket
 ChunkPacket parse_packet(const uint8_t* data, std::size_t len);
 
+// Byte array → PacketView (kopyasız; view, data tamponu yaşadığı sürece geçerli)
+// Paket çok kısaysa, sürüm uymuyorsa veya payload block_size ile tutmuyorsa false döner
+bool parse_packet_view(const uint8_t* data, std::size_t len, PacketView& view);
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "packet_parser.hpp"
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// Son gönderilen frame'lerin blokları; NACK gelince (frame_id, group, block) ile bulunur.
+// Slot'lar frame_id % FRAME_COUNT ile seçilir ve tamponları yeniden kullanılır:
+// encoder çıktısı swap ile devralınır, parity doğrudan slot'a kodlanır (ek kopya yok).
+class RetransmitRing {
+public:
+    static constexpr size_t FRAME_COUNT = 16;   // 2'nin kuvveti; 30 fps'te ~500 ms geçmiş
+
+    struct Frame {
+        bool valid = false;
+        uint32_t frame_id = 0;
+        uint8_t k = 0;
+        uint8_t r = 0;
+        uint16_t block_size = 0;
+        uint32_t frame_length = 0;
+        uint32_t group_count = 0;
+        std::vector<uint8_t> encoded;   // encoder çıktısı; tam veri blokları buradan okunur
+        std::vector<uint8_t> tail;      // frame sonunu aşan veri blokları, sıfır dolgulu
+        std::vector<uint8_t> parity;    // group g, parity p → (g * r + p) * block_size
+        std::chrono::steady_clock::time_point sent_time;
+
+        // Grup bloğu: index < k veri, >= k parity
+        const uint8_t* block(uint32_t group, int index) const;
+    };
+
+    RetransmitRing();
+
+    // frame_id için slot'u hazırlar; aynı slot'taki eski frame'in yerine geçer.
+    // Eski frame'in paketleri hâlâ bir kuyrukta (pacer) olabilir: önce occupant() ile bulunup
+    // oradan atılmalıdır, yoksa kuyruk yeniden kullanılan tamponu okur
+    Frame& prepare(uint32_t frame_id);
+
+    // frame_id'nin slot'unda duran başka bir geçerli frame (prepare() onu silecek), yoksa nullptr
+    const Frame* occupant(uint32_t frame_id) const;
+
+    // Frame hâlâ halkadaysa bloğu yeniden gönderilecek paket olarak doldurur (timestamp hariç)
+    bool lookup(uint32_t frame_id, uint16_t group, uint8_t block_index, PacketView& out) const;
+
+    // Frame halkadaysa slot'u, değilse nullptr
+    const Frame* find(uint32_t frame_id) const;
+
+private:
+    std::vector<Frame> frames_;
+};
@@ -23,8 +23,11 @@ public:
     void receivePong(int port, int64_t timestamp);
     double getRTT(int port);
     double getAverageRTT();
+    void recordRTT(int port, double rtt_ms);   // dışarıda ölçülen RTT (ör. alıcı raporu)
 
 private:
+    void add_sample(int port, double rtt_ms);   // kilit tutulurken çağrılır
+
     std::unordered_map<int, std::chrono::steady_clock::time_point> ping_sent_time;
     std::unordered_map<int, double> rtt_map;
     std::unordered_map<int, int64_t> ping_timestamps;
@@ -29,6 +29,6 @@ private:
     void build_weight_table();
 };
 
-// 🔥 Global olarak seçimi kolaylaştıran interface
-void init_scheduler(const std::vector<int>& ports); // Basit RTT bilmeden başlatmak için
-int select_port_for_chunk(int chunk_id);
+// RTT ve kayıp henüz bilinmeden portlar için başlangıç yolları (RTT 50ms, kayıp 0);
+// sonra RTTMonitor ve LossTracker ölçümleriyle update_metrics() çağrılır
+std::vector<PathStats> default_path_stats(const std::string& ip, const std::vector<int>& ports);
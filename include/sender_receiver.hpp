@@ -1,10 +1,48 @@
 #pragma once
 
+#include "session.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
+namespace cv { class Mat; }
+class FrameSource;
+class NetworkImpairment;
 
-void run_sender(const std::string& public_ip, const std::vector<int>& ports);
+// Kamera/dosya → H.264 → oturum ve oturum → H.264 → ekran uygulamaları (novaengine_core üzerinde)
 
+// Çalışma sayaçları: taşıma sayaçlarını oturumlar, decode sayısını run_receiver artırır;
+// çağıran (ör. benchmark) okur
+struct RunCounters : TransportCounters {
+    std::atomic<uint64_t> frames_decoded{0};
+};
 
-void run_receiver(const std::vector<int>& ports);
+// Çalışma seçenekleri
+struct RunOptions {
+    bool headless = false;                     // pencere yok: HighGUI hiç çağrılmaz, ekran thread'i açılmaz
+    const std::atomic<bool>* stop = nullptr;   // true olunca döngüler kapanır (ör. SIGINT); yoksa yalnızca pencereden
+    std::string source = "camera";             // gönderici frame kaynağı, bkz. open_frame_source()
+    std::shared_ptr<FrameSource> frame_source; // verilirse source yerine bu kullanılır
+    std::vector<int> local_ports;              // gönderici soketlerinin yerel portları (hedef port başına bir); boşsa hedef portlar, 0: sistem seçer
+    std::shared_ptr<NetworkImpairment> impairment;   // test: gönderici datagram'ları emülatörden geçer
+
+    int width = 640;                           // istenen boyut; kamera ve Y4M kendi boyutunu bildirebilir
+    int height = 480;
+    int fps = 30;
+    int bitrate = 600000;                      // başlangıç hedefi (bit/s)
+    bool adapt_bitrate = true;                 // false: tıkanıklık denetleyicisi hedefi değiştirmez
+    int fec_k = 8;                             // grup başına veri bloğu
+    int fec_r = 4;                             // grup başına parity bloğu (k + r <= 64)
+
+    std::function<void(const cv::Mat&)> on_decoded;   // alıcı: decode edilen her frame (BGR), decode thread'inde
+    RunCounters* counters = nullptr;
+};
+
+
+void run_sender(const std::string& public_ip, const std::vector<int>& ports, const RunOptions& options = {});
+
+
+void run_receiver(const std::vector<int>& ports, const RunOptions& options = {});
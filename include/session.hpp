@@ -0,0 +1,136 @@
+#pragma once
+
+#include "stage_counters.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class NetworkImpairment;
+
+// novaengine_core oturum API'si: kamera, encoder ve pencere yok; uygulama encode edilmiş frame'leri
+// verir (SenderSession) ve yeniden birleştirilmiş frame'leri callback ile alır (ReceiverSession).
+// Tüm durum oturum nesnesindedir (soketler, FEC, pacer, geri bildirim); bir process'te istenen
+// sayıda oturum, farklı portlarla, yan yana çalışır. Kurulum hatalarında std::runtime_error.
+
+// Taşıma sayaçları: oturum artırır, çağıran okur (birkaç oturum aynı sayaçları paylaşabilir)
+struct TransportCounters {
+    std::atomic<uint64_t> frames_sent{0};          // FEC'lenip pacer'a verilen frame'ler
+    std::atomic<uint64_t> datagrams_sent{0};       // yeniden gönderimler dahil, soketten çıkanlar
+    std::atomic<uint64_t> bytes_sent{0};
+    std::atomic<uint64_t> datagrams_received{0};
+    std::atomic<uint64_t> frames_reassembled{0};   // callback'e verilen frame'ler
+};
+
+struct SenderSessionConfig {
+    std::string remote_ip;
+    std::vector<int> remote_ports;             // yol başına bir hedef port
+    std::vector<int> local_ports;              // boşsa remote_ports; 0: sistem seçer
+
+    int fec_k = 8;                             // grup başına veri bloğu
+    int fec_r = 4;                             // grup başına parity bloğu (k + r <= 64)
+
+    int bitrate = 600000;                      // başlangıç hedefi (bit/s)
+    int min_bitrate = 150000;                  // tıkanıklık denetleyicisinin sınırları
+    int max_bitrate = 4000000;
+    bool adapt_bitrate = true;                 // false: hedef hiç değişmez, raporlar yalnızca ölçülür
+    int fps = 30;                              // başlangıç frame hızı; pacer bir frame'i bu aralığa yayar
+
+    bool kernel_pacing = true;                 // SO_TXTIME, çekirdek destekliyorsa
+    size_t queue_depth = 4;                    // send_frame ile ağ thread'i arasındaki frame kuyruğu
+
+    std::shared_ptr<NetworkImpairment> impairment;   // test: datagram'lar çekirdek yerine emülatöre
+    TransportCounters* counters = nullptr;
+};
+
+// Gönderici oturumu: frame → (k, r) FEC grupları → pacer → UDP; alıcı raporlarıyla RTT/kayıp
+// ölçümü, tıkanıklık denetimi ve NACK'lenen blokların yeniden gönderimi. FEC, gönderim ve geri
+// bildirim oturumun ağ thread'inde yapılır; send_frame yalnızca kuyruğa koyar.
+class SenderSession {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Soketleri açar ve thread'leri başlatır
+    explicit SenderSession(const SenderSessionConfig& config);
+    ~SenderSession();
+
+    SenderSession(const SenderSession&) = delete;
+    SenderSession& operator=(const SenderSession&) = delete;
+
+    // Thread'leri durdurur ve soketleri kapatır (kuyrukta kalanlar gönderilmez); tekrar çağrılabilir
+    void stop();
+
+    // Encode edilmiş bir frame'i (tek bir decode birimi, ör. H.264 access unit) kuyruğa koyar.
+    // Kopyasız: frame'in içeriği kuyruğun tamponuyla takas edilir, frame kapasitesi korunmuş eski
+    // bir tamponla döner. Kuyruk doluysa false (frame'e dokunulmaz); kodlayıcı zinciri frame
+    // atlamaya dayanmaz, çağıran biraz bekleyip yeniden dener.
+    // Tek üretici: yalnızca bir thread'den çağrılmalı
+    bool send_frame(std::vector<uint8_t>& frame, Clock::time_point captured = Clock::now());
+    bool send_frame(const uint8_t* data, size_t size, Clock::time_point captured = Clock::now());
+
+    // Tıkanıklık denetleyicisinin güncel kararı; kodlayıcı ve yakalama bunları izler
+    int target_bitrate() const;
+    int target_fps() const;
+
+    struct Stats {
+        size_t queued_frames = 0;              // send_frame kuyruğu
+        size_t pacer_queued = 0;               // pacer'da bekleyen paketler
+        uint64_t pacer_dropped = 0;            // retransmit halkası slot'u devralınca gönderilmeden atılanlar
+        double rtt_ms = 0.0;
+        double loss_rate = 0.0;                // 0..1, rapor edilen alım sayılarından
+        int recent_frame_losses = 0;           // alıcının son 64 frame'inden kaybolanlar
+        uint64_t blocks_resent = 0;
+        uint64_t resends_skipped = 0;          // alıcının süresine yetişmeyeceği için gönderilmeyenler
+        StageCounters::Snapshot send;          // FEC + kuyruklama; son stats() çağrısından beri
+    };
+    Stats stats();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;   // API sabit kalsın diye tüm durum burada
+};
+
+struct ReceiverSessionConfig {
+    std::vector<int> local_ports;              // dinlenen portlar (yol başına bir)
+    int fec_k = 8;                             // beklenen FEC şekli (önceden hazırlanır); farklısı başlıktan öğrenilir
+    int fec_r = 4;
+    int retransmit_budget_ms = 60;             // eksik frame yeniden gönderim için bu kadar bekler; 0: NACK yok
+    TransportCounters* counters = nullptr;
+};
+
+// Alıcı oturumu: kendi thread'inde epoll/recvmmsg ile alır, FEC ile frame'leri birleştirir,
+// göndericiye NACK ve alıcı raporları yollar. Tamamlanan her frame on_frame'e verilir
+// (oturumun alım thread'inde; data yalnızca çağrı süresince geçerli, uzun iş başka thread'e aktarılmalı).
+class ReceiverSession {
+public:
+    using FrameCallback = std::function<void(const uint8_t* data, size_t size)>;
+
+    // Portlara bind eder ve alım thread'ini başlatır
+    ReceiverSession(const ReceiverSessionConfig& config, FrameCallback on_frame);
+    ~ReceiverSession();
+
+    ReceiverSession(const ReceiverSession&) = delete;
+    ReceiverSession& operator=(const ReceiverSession&) = delete;
+
+    // Alım thread'ini durdurur ve soketleri kapatır; tekrar çağrılabilir
+    void stop();
+
+    // Herhangi bir thread'den okunabilir; jitter ve oynatma gecikmesi her alım turunda güncellenir
+    struct Stats {
+        double jitter_ms = 0.0;                // RFC 3550 tahmini, gönderici timestamp'lerinden
+        int playout_delay_ms = 0;              // jitter buffer'ın şu anki gecikmesi
+        uint64_t groups_systematic = 0;        // tüm veri blokları geldi
+        uint64_t groups_reconstructed = 0;     // parity ile yeniden üretildi
+        uint64_t frames_lost = 0;              // oynatma sırasında vazgeçilenler
+        uint64_t nacks_sent = 0;
+    };
+    Stats stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <cstdint>
+#include <cstddef>
 
 struct Chunk {
     uint32_t frame_id;
@@ -14,3 +15,17 @@ std::vector<Chunk> slice_frame(const std::vector<uint8_t>& frame_data,
                                uint32_t frame_id,
                                uint16_t chunk_size);
 
+
+// Çok gruplu FEC yerleşimi: frame → group_count adet (k veri + r parity) grup,
+// tüm bloklar block_size bayt (son grup sıfırla doldurulur)
+struct FecLayout {
+    int k;
+    int r;
+    int group_count;
+    size_t block_size;
+};
+
+// block_size <= max_block_size olacak kadar grup açar (en fazla max_groups);
+// bloklar gruplara eşit dağıtılır ki dolgu en az olsun
+FecLayout plan_fec_groups(size_t frame_size, int k, int r,
+                          size_t max_block_size, int max_groups);
@@ -2,7 +2,11 @@
 
 #include "packet_parser.hpp"
 #include "erasure_coder.hpp"
-#include <unordered_map>
+#include "timer_wheel.hpp"
+#include "feedback.hpp"
+#include <map>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <functional>
 #include <chrono>
@@ -11,32 +15,174 @@
 
 class SmartFrameCollector {
 public:
-    using FrameReadyCallback = std::function<void(const std::vector<uint8_t>&)>;
+    // data yalnızca çağrı süresince geçerlidir (collector'ın kendi tamponuna bakan view)
+    using FrameReadyCallback = std::function<void(const uint8_t* data, size_t size)>;
 
+    // Tek yazar: handle(), flush_expired_frames() ve poll_timeout_ms() yalnızca ingest
+    // thread'inden çağrılır (debug build'de denetlenir). Kilit yok; tamamlanan frame'leri
+    // başka bir thread'e aktarmak callback'in işidir (ör. SpscRing).
+    // k, r: beklenen FEC şekli (önceden hazırlanır); farklı şekiller başlıktan öğrenilir
     SmartFrameCollector(FrameReadyCallback callback, int k, int r);
-    ~SmartFrameCollector();
     void handle(ChunkPacket pkt);
+    // Payload tek kopya ile frame'in blok matrisindeki yerine yazılır
+    void handle(const PacketView& pkt);
     void flush_expired_frames();
 
+    // Bir sonraki frame deadline'ına kalan süre, en fazla max_ms (receive poll timeout'u)
+    int poll_timeout_ms(int max_ms) const;
+
+    // Adaptif jitter buffer: paket timestamp'lerinden RFC 3550 jitter tahmini (J);
+    // oynatma gecikmesi = clamp(PLAYOUT_BASE_MS + 4J, MIN, MAX).
+    // Frame'ler frame_id sırasıyla, ilk paketlerinden bu gecikme sonra bırakılır; eksik bir frame
+    // de en fazla bu kadar beklenir. Jitter PLAYOUT_FAST_PATH_JITTER_MS altındaysa tamamlanan
+    // frame beklemeden bırakılır.
+    double jitter_ms() const { return jitter_us_ / 1000.0; }
+    int playout_delay_ms() const;
+
+    // Grup istatistikleri: tüm veri blokları geldi (FEC'siz) / parity ile yeniden üretildi.
+    // Başka thread'lerden okunabilir.
+    uint64_t systematic_hits() const { return systematic_hits_.load(std::memory_order_relaxed); }
+    uint64_t reconstructions() const { return reconstructions_.load(std::memory_order_relaxed); }
+
+    // Hibrit ARQ: FEC'in kurtaramadığı gruplar için NACK. Frame NACK gecikmesi boyunca
+    // sessiz kalırsa eksik blokların k'ya yetecek kadarı istenir (önce veri blokları).
+    // retransmit_budget_ms oynatma gecikmesine eklenir: yeniden gönderimlere ayrılan süre.
+    using NackHandler = std::function<void(const NackEntry& entry)>;
+    void enable_nack(NackHandler handler, int retransmit_budget_ms);
+    int nack_delay_ms() const;
+    uint64_t nacks_sent() const { return nacks_sent_.load(std::memory_order_relaxed); }
+
+    // Alıcı raporunun frame alanları: en yeni frame, oynatma sırasında son karara bağlanan
+    // frame ve son 64 kararın kayıp maskesi. Yalnızca ingest thread'inden çağrılır.
+    void fill_report(ReceiverReport& report) const;
+    uint64_t frames_lost() const { return frames_lost_.load(std::memory_order_relaxed); }
+    // Desteklenmeyen FEC şekli yüzünden düşürülen frame'ler
+    uint64_t shape_rejections() const { return shape_rejections_.load(std::memory_order_relaxed); }
+
+    static constexpr int NACK_MIN_DELAY_MS = 2;   // yeniden sıralama toleransı
+    static constexpr int NACK_MAX_DELAY_MS = 20;
+    static constexpr int MAX_NACK_ROUNDS = 2;
+
+    static constexpr int PLAYOUT_BASE_MS = 5;
+    static constexpr int MIN_PLAYOUT_MS = 5;
+    static constexpr int MAX_PLAYOUT_MS = 150;   // MAX_FRAME_AGE'in altında kalır
+    static constexpr double PLAYOUT_FAST_PATH_JITTER_MS = 1.0;
+
+    // Halka kapasitesi (2'nin kuvveti): en yeni frame'den bu kadar geride kalan paketler bayat sayılır
+    static constexpr size_t SLOT_COUNT = 32;
+    // Art arda bu kadar paket en yeni frame'den SLOT_COUNT veya daha fazla gerideyse gönderici
+    // yeniden başlamış sayılır (frame_id geri sarıldı): halka ve oynatma sırası sıfırlanır
+    static constexpr int RESTART_STALE_PACKETS = 8;
+    static constexpr uint32_t MAX_GROUPS = 1024;                // frame başına en fazla grup
+    static constexpr uint32_t MAX_FRAME_LENGTH = 16 * 1024 * 1024;
+    // Slot başına blok matrisi (veri + parity) sınırı: parity frame'i en fazla ikiye katlar.
+    // Sahte bir başlık (ör. k=1, r=63) slot başına yüzlerce MB ayırtamaz
+    static constexpr size_t MAX_SLOT_BYTES = 2 * static_cast<size_t>(MAX_FRAME_LENGTH);
+
 private:
+    // Block matrix layout: all data blocks first (group g, block j → g * k + j), then all
+    // parity blocks (group g, parity p → group_count * k + g * r + p). The data region is the
+    // contiguous frame once every group has been recovered.
+    // Slot durumu: READY → çözüldü, sırasını bekliyor; DONE → teslim edildi ya da
+    // vazgeçildi, geç gelen kopyalar yutulur
+    enum class SlotState : uint8_t { EMPTY, ASSEMBLING, READY, DONE };
+
+    // Slot'lar frame_id % SLOT_COUNT ile seçilir; tamponlar kapasitelerini korur,
+    // böylece sabit durumda frame başına bellek ayırma olmaz
     struct PartialFrame {
-        std::vector<std::vector<uint8_t>> chunks;
-        std::vector<bool> received_flags;
-        uint8_t total_chunks = 0;
+        SlotState state = SlotState::EMPTY;
+        uint32_t frame_id = 0;
+        std::vector<uint8_t> blocks;
+        std::vector<uint64_t> group_masks;   // group g: bit i → group block i alındı (grup çözülünce tüm bitler 1)
+        ErasureCoder* fec = nullptr;         // frame'in (k, r) şekline ait kodlayıcı
+        int k = 0;
+        int r = 0;
+        size_t block_size = 0;
+        uint32_t frame_length = 0;           // dolgusuz frame boyu
+        uint32_t group_count = 0;
+        int groups_ready = 0;                // k bloğa ulaşıp çözülen grup sayısı
         size_t received_chunks = 0;
         std::chrono::steady_clock::time_point last_update;
         std::chrono::steady_clock::time_point arrival_time;
+        TimerWheel::TimerId age_timer = 0;      // arrival + MAX_FRAME_AGE
+        TimerWheel::TimerId playout_timer = 0;  // ASSEMBLING: last_update + oynatma gecikmesi (tetiklenince yeniden kurulur)
+                                                // READY: sıradaysa release_at, değilse önceki frame'leri bekleme sınırı
+        std::chrono::steady_clock::time_point release_at;  // READY: arrival + oynatma gecikmesi (hızlı yolda hemen)
+        bool release_armed = false;             // playout_timer release_at'e kurulu
+        TimerWheel::TimerId nack_timer = 0;     // last_update + NACK gecikmesi
+        int nack_rounds = 0;
     };
 
-    std::unordered_map<uint16_t, PartialFrame> frame_buffer;
+    // Zamanlayıcı etiketi: frame_id << 2 | tür
+    enum DeadlineKind : uint64_t { DEADLINE_AGE = 0, DEADLINE_PLAYOUT = 1, DEADLINE_HOLD = 2, DEADLINE_NACK = 3 };
+
+    uint8_t* block_ptr(PartialFrame& frame, int group, int index) const;
+
+    // Paketin slot'unu bulur/yeniden kullanır; bayat ya da kapanmış frame için nullptr
+    PartialFrame* slot_for(const PacketView& pkt);
+    // Tüm slot'ları boşaltır; sonraki paket yeni bir frame_id dizisi başlatır
+    void reset_sequence(uint32_t frame_id);
+    void abandon(PartialFrame& frame, const char* reason);
+    // Slot'u kapatır ve bekleyen deadline'larını iptal eder
+    void finish(PartialFrame& frame);
+    void on_deadline(uint64_t tag);
+    void update_jitter(int64_t sender_timestamp_us);
+    void on_nack_deadline(PartialFrame& frame, uint64_t tag);
+    void send_nacks(PartialFrame& frame);
+
+    // Sıradaki frame'den başlayarak hazır olanları sırayla teslim eder
+    void release_ready();
+    // frame_id'den önceki tüm frame'lerden vazgeçer (oynatma sırası frame_id'ye atlar)
+    void skip_to(uint32_t frame_id);
+    // Frame callback'e verildiyse true (çok eskiyse düşürülür)
+    bool deliver(PartialFrame& frame);
+    // Oynatma noktası count frame ilerledi; lost ise hepsi kayıp sayılır
+    void record_playout(uint32_t count, bool lost);
+    // Grubun eksik veri bloklarını frame'in kendi matrisinde yerinde üretir
+    bool decode_group(PartialFrame& frame, int group);
+
+    // (k, r) → kodlayıcı; alıcı FEC şeklini her frame'in başlığından alır.
+    // Desteklenmeyen şekil nullptr olarak önbelleğe alınır, log saniyede bir satırla sınırlı
+    ErasureCoder* coder_for(int k, int r);
+    void reject_shape(int k, int r, const char* reason);
+
     FrameReadyCallback callback;
+    std::vector<PartialFrame> slots_;
+    uint32_t newest_frame_id_ = 0;
+    bool have_newest_ = false;
+    int stale_run_ = 0;                  // art arda gelen bayat paket sayısı
+
+    // Oynatma sırası: sıradaki teslim edilecek frame_id
+    uint32_t next_release_ = 0;
+    bool have_release_ = false;
+    uint64_t playout_loss_mask_ = 0;     // bit i → next_release_ - 1 - i oynatılamadı
+    std::atomic<uint64_t> frames_lost_{0};
+
+    NackHandler nack_handler_;
+    int retransmit_budget_ms_ = 0;
+    std::atomic<uint64_t> nacks_sent_{0};
+
+    std::atomic<uint64_t> systematic_hits_{0};
+    std::atomic<uint64_t> reconstructions_{0};
+
+    // RFC 3550 jitter tahmincisi (mikrosaniye)
+    double jitter_us_ = 0.0;
+    int64_t last_transit_us_ = 0;
+    bool have_transit_ = false;
+
+    // Frame deadline'ları: expiry maliyeti O(tamponlanan) değil O(süresi dolan)
+    TimerWheel deadlines_;
+    TimerWheel::ExpireHandler on_deadline_;
 
-    std::thread flush_thread;
-    bool stop_flag = false;
-    int timeout_ms_ = 50;
+    void check_owner() const;
+#ifndef NDEBUG
+    mutable std::thread::id owner_;
+#endif
 
-    ErasureCoder fec;
-    int k_; // data chunks
-    int r_; // parity chunks
+    std::map<std::pair<int, int>, std::unique_ptr<ErasureCoder>> coders_;
+    std::atomic<uint64_t> shape_rejections_{0};
+    uint64_t shape_log_suppressed_ = 0;
+    std::chrono::steady_clock::time_point last_shape_log_;
+    bool have_shape_log_ = false;
 };
 
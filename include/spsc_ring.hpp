@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+// Tek üretici / tek tüketici halka: slot'lar önceden ayrılır ve yeniden kullanılır.
+// Üretici: acquire() → slot'u doldur → publish(). Tüketici: peek() → oku → release().
+// Kilit yok; yalnızca head/tail üzerinde acquire/release sıralaması.
+template <typename T>
+class SpscRing {
+public:
+    // capacity 2'nin kuvvetine yuvarlanır
+    explicit SpscRing(size_t capacity) : slots_(round_up(capacity)), mask_(slots_.size() - 1) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Üretici: yazılacak boş slot, halka doluysa nullptr
+    T* acquire() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == slots_.size()) return nullptr;
+        return &slots_[head & mask_];
+    }
+
+    // Üretici: acquire() ile alınan slot'u tüketiciye görünür yapar
+    void publish() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Tüketici: en eski dolu slot, halka boşsa nullptr
+    T* peek() {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) return nullptr;
+        return &slots_[tail & mask_];
+    }
+
+    // Tüketici: peek() ile okunan slot'u üreticiye geri verir
+    void release() {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    size_t capacity() const { return slots_.size(); }
+
+    // Yaklaşık doluluk (diğer taraf eşzamanlı ilerleyebilir)
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    static size_t round_up(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    std::vector<T> slots_;
+    const size_t mask_;
+
+    // Üretici ve tüketici sayaçları ayrı cache line'larda: false sharing olmasın
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Pipeline aşaması sayaçları: aşamanın kendi thread'i yazar, istatistik thread'i okur ve sıfırlar.
+// Kilit yok; take() ile okunan değerler birbirine göre yaklaşık tutarlıdır.
+struct StageCounters {
+    std::atomic<uint64_t> frames{0};       // aşamadan çıkan frame sayısı
+    std::atomic<uint64_t> dropped{0};      // giriş kuyruğunda atlanan (en eski) frame'ler
+    std::atomic<uint64_t> work_us{0};      // aşamanın kendi işine harcadığı süre
+    std::atomic<uint64_t> latency_us{0};   // yakalamadan bu aşamanın çıkışına geçen süre
+
+    void record(std::chrono::steady_clock::duration work, std::chrono::steady_clock::duration latency) {
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        frames.fetch_add(1, std::memory_order_relaxed);
+        work_us.fetch_add(duration_cast<microseconds>(work).count(), std::memory_order_relaxed);
+        latency_us.fetch_add(duration_cast<microseconds>(latency).count(), std::memory_order_relaxed);
+    }
+
+    // Son take()'ten beri: frame/drop sayıları ve frame başına ortalama süreler (ms)
+    struct Snapshot {
+        uint64_t frames = 0;
+        uint64_t dropped = 0;
+        double work_ms = 0.0;
+        double latency_ms = 0.0;
+    };
+
+    Snapshot take() {
+        Snapshot s;
+        s.frames = frames.exchange(0, std::memory_order_relaxed);
+        s.dropped = dropped.exchange(0, std::memory_order_relaxed);
+        uint64_t work = work_us.exchange(0, std::memory_order_relaxed);
+        uint64_t latency = latency_us.exchange(0, std::memory_order_relaxed);
+        if (s.frames > 0) {
+            s.work_ms = work / 1000.0 / s.frames;
+            s.latency_ms = latency / 1000.0 / s.frames;
+        }
+        return s;
+    }
+};
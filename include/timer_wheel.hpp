@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+// Hiyerarşik zamanlayıcı çarkı: 1 ms tick, seviye başına 256 slot, 4 seviye (~49 gün).
+// schedule/cancel O(1); advance yalnızca geçen tick'ler ve süresi dolan zamanlayıcılar kadar iş yapar.
+// Thread-safe değildir: sahibi olan thread'den (ya da sahibinin kilidi altında) kullanılır.
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    // 0 geçersiz kimliktir; kimlik nesil sayacı taşır, bayat kimlikle cancel etkisizdir
+    using TimerId = uint64_t;
+    using ExpireHandler = std::function<void(uint64_t tag)>;
+
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 8;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+
+    explicit TimerWheel(Clock::time_point start = Clock::now());
+
+    // deadline geçmişse bir sonraki advance'te tetiklenir
+    TimerId schedule(Clock::time_point deadline, uint64_t tag);
+    // Tembel iptal: düğüm, slot'u işlendiğinde geri kazanılır
+    bool cancel(TimerId id);
+
+    // now'a kadar süresi dolanlar için handler(tag); handler yeni zamanlayıcı kurabilir
+    size_t advance(Clock::time_point now, const ExpireHandler& handler);
+
+    // Bir sonraki olası tetiklemeye kalan ms, en fazla max_ms (poll timeout'u için; erken olabilir, geç olmaz)
+    int ms_until_next(int max_ms, Clock::time_point now = Clock::now()) const;
+
+    size_t pending() const { return armed_; }
+
+private:
+    struct Node {
+        uint64_t expires = 0;    // mutlak tick
+        uint64_t tag = 0;
+        uint32_t generation = 1;
+        int32_t next = -1;
+        bool armed = false;
+    };
+
+    uint64_t tick_of(Clock::time_point t) const;
+    void insert(int32_t index);
+    void cascade(int level, int slot);
+    void release(int32_t index);
+
+    Clock::time_point start_;
+    uint64_t current_tick_ = 0;   // işlenecek sıradaki tick
+    size_t armed_ = 0;
+
+    std::vector<Node> nodes_;
+    std::vector<int32_t> free_;
+    std::array<std::array<int32_t, SLOTS>, LEVELS> slots_;
+};
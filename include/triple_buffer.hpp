@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Tek yazar / tek okur için "en son değer" kanalı: yazar hiç beklemez, okur her zaman
+// yayımlanan en yeni tamponu alır; aradaki değerlerin atlanması beklenen davranıştır.
+// Üç tampon: yazarın arka tamponu, okurun ön tamponu ve aralarında takas edilen orta tampon.
+// Orta tamponun indeksi ve "yeni" biti tek bir atomic bayttadır.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Yazar: doldurulacak tampon (önceki içeriği eski bir değerdir, kapasitesi korunur)
+    T& write_buffer() { return buffers_[back_]; }
+
+    // Yazar: write_buffer()'ı okura verir, karşılığında orta tamponu alır.
+    // Okunmamış bir değerin üzerine yazıldıysa (okur onu hiç görmeyecek) true döner.
+    bool publish() {
+        uint8_t previous = middle_.exchange(static_cast<uint8_t>(back_ | FRESH), std::memory_order_acq_rel);
+        back_ = previous & INDEX_MASK;
+        return (previous & FRESH) != 0;
+    }
+
+    // Okur: son okumadan beri yeni bir değer yayımlandıysa onu, yoksa nullptr.
+    // Dönen tampon bir sonraki read() çağrısına kadar okura aittir.
+    T* read() {
+        if (!(middle_.load(std::memory_order_acquire) & FRESH)) return nullptr;
+        uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = previous & INDEX_MASK;
+        return &buffers_[front_];
+    }
+
+private:
+    static constexpr uint8_t FRESH = 0x4;
+    static constexpr uint8_t INDEX_MASK = 0x3;
+
+    std::array<T, 3> buffers_;
+    alignas(64) std::atomic<uint8_t> middle_{1};
+    alignas(64) uint8_t back_ = 0;    // yalnızca yazar
+    alignas(64) uint8_t front_ = 2;   // yalnızca okur
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <netinet/in.h>
+
+// epoll + recvmmsg tabanlı alıcı: her uyanışta soket başına 64 datagram'a kadar toplu okuma
+class UdpReceiver {
+public:
+    static constexpr unsigned int BATCH_SIZE = 64;
+    static constexpr size_t MAX_DATAGRAM = 1536;  // 8 bayt hizalı slotlar: v2 başlığı yerinde okunur
+    static constexpr int MAX_DRAIN_ROUNDS = 4;  // Soket başına uyanış başına en fazla 4 batch (adalet için)
+
+    // data yalnızca çağrı süresince geçerlidir; port → datagram'ın geldiği yerel port,
+    // from → gönderenin adresi (geri bildirim buraya yollanır)
+    using DatagramHandler = std::function<void(const uint8_t* data, size_t len, int port,
+                                               const sockaddr_in& from)>;
+
+    UdpReceiver();
+    ~UdpReceiver();
+
+    UdpReceiver(const UdpReceiver&) = delete;
+    UdpReceiver& operator=(const UdpReceiver&) = delete;
+
+    // Portlara bind eder ve epoll'a kaydeder
+    bool open(const std::vector<int>& ports);
+    void close();
+
+    // En fazla timeout_ms bekler, hazır soketleri boşaltır.
+    // Dönen değer: işlenen datagram sayısı, hata durumunda -1
+    int poll(int timeout_ms, const DatagramHandler& handler);
+
+    // Yerel port'a bağlı soketten to adresine tek datagram (geri bildirim için, non-blocking)
+    ssize_t send_to(int port, const sockaddr_in& to, const uint8_t* data, size_t len);
+
+private:
+    struct Socket {
+        int fd;
+        int port;
+    };
+
+    int drain(const Socket& sock, const DatagramHandler& handler);
+
+    int epoll_fd_ = -1;
+    std::vector<Socket> sockets_;
+
+    // recvmmsg için önceden ayrılmış batch tamponları
+    std::vector<uint8_t> buffers_;
+    std::vector<iovec> iovs_;
+    std::vector<mmsghdr> msgs_;
+    std::vector<sockaddr_in> addrs_;
+};
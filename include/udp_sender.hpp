@@ -3,17 +3,102 @@
 #include "packet_parser.hpp"  // ChunkPacket burada tanımlı
 #include <vector>
 #include <string>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <poll.h>
 
-// UDP soketlerini açar ve belirtilen yerel portlara bind eder
-bool init_udp_sockets(const std::vector<int>& local_ports);
+class NetworkImpairment;
 
-// Soketleri kapatır
-void close_udp_sockets();
+// Toplu gönderim sonucu: datagrams_per_path[i] → ports[i] yoluna çıkan datagram sayısı
+struct BatchSendResult {
+    std::vector<int> datagrams_per_path;
+    size_t datagrams_sent = 0;
+    size_t bytes_sent = 0;
+};
 
-void set_target_addresses(const std::string& target_ip, const std::vector<int>& ports);
+// Gönderici soketleri ve hedef adresleri. Her oturumun kendi nesnesi vardır; bir process'te
+// birden çok gönderici birbirine dokunmadan çalışır.
+// Thread kullanımı: send/send_batch tek bir gönderim thread'inden (ör. pacer), poll_feedback
+// tek bir başka thread'den çağrılabilir; open/close/set_targets gönderim başlamadan ve bittikten sonra.
+class UdpSender {
+public:
+    UdpSender() = default;
+    ~UdpSender();
 
-// Bir ChunkPacket'i hedef IP ve port'a gönder
-// Non-blocking send; dönen byte sayısı <0 ise hata
-ssize_t send_udp(const std::string& target_ip, int port, const ChunkPacket& packet);
-ssize_t send_udp_multipath(const std::string& target_ip, const std::vector<int>& ports, const ChunkPacket& packet);
+    UdpSender(const UdpSender&) = delete;
+    UdpSender& operator=(const UdpSender&) = delete;
 
+    // UDP soketlerini açar ve belirtilen yerel portlara bind eder (0: sistem seçer).
+    // Açık soketler (ve emülatör) önce kapatılır; hata olursa hiçbir soket açık kalmaz
+    bool open(const std::vector<int>& local_ports);
+
+    // Soketleri kapatır; önce emülatörü durdurur
+    void close();
+
+    // Hedef adresleri önceden hesaplar (gönderim yolunda inet_pton yapılmasın)
+    void set_targets(const std::string& target_ip, const std::vector<int>& ports);
+
+    // Bir ChunkPacket'i hedef IP ve port'a gönder
+    // Non-blocking send; dönen byte sayısı <0 ise hata
+    ssize_t send(const std::string& target_ip, int port, const ChunkPacket& packet);
+    ssize_t send_multipath(const std::string& target_ip, const std::vector<int>& ports, const ChunkPacket& packet);
+
+    // Bir frame'in (veya birkaç frame'in) tüm bloklarını her yola gönderir.
+    // Her soket için tek bir sendmmsg çağrısı yapılır; yol i → soket (i % soket sayısı).
+    // Payload kopyalanmaz: başlık küçük bir tampona yazılır, payload iovec ile doğrudan gönderilir.
+    // departure_ns verilirse (packets ile aynı sırada, CLOCK_MONOTONIC) her datagram SO_TXTIME
+    // kalkış zamanıyla gönderilir; önce enable_txtime() başarılı olmalı
+    BatchSendResult send_batch(const std::string& target_ip, const std::vector<int>& ports,
+                               const std::vector<PacketView>& packets,
+                               const int64_t* departure_ns = nullptr);
+
+    // Test/benchmark: bundan sonra gönderilen datagram'lar çekirdek yerine emülatöre gider
+    // (yol = send_batch'teki ports indeksi). Gönderim başlamadan önce çağrılmalı; nullptr kaldırır.
+    // close() emülatörü durdurur ve bırakır. Ayarlı değilken gönderim yolu değişmez.
+    void set_impairment(std::shared_ptr<NetworkImpairment> impairment);
+
+    // Çekirdek destekli pacing: soketlerde SO_TXTIME'ı açar. Kalkış zamanlarına fq/etf qdisc uyar;
+    // başka bir qdisc'te paketler beklemeden çıkar. Çekirdek ya da başlıklar desteklemiyorsa false
+    bool enable_txtime();
+
+    // Bağlı soketlere (open) alıcıdan dönen geri bildirim datagramlarını okur.
+    // En fazla timeout_ms bekler; data yalnızca çağrı süresince geçerlidir.
+    // Dönen değer: işlenen datagram sayısı, hata durumunda -1
+    using FeedbackHandler = std::function<void(const uint8_t* data, size_t len, int local_port)>;
+    int poll_feedback(int timeout_ms, const FeedbackHandler& handler);
+
+    bool is_open() const { return !sockets_.empty(); }
+
+private:
+    size_t target_index(const std::string& target_ip, int port);
+
+    std::vector<int> sockets_;
+    std::vector<int> local_ports_;
+    std::vector<std::string> target_ips_;
+    std::vector<int> target_ports_;
+    std::vector<sockaddr_in> target_addrs_;
+    bool txtime_enabled_ = false;
+    std::shared_ptr<NetworkImpairment> impairment_;
+    size_t next_socket_ = 0;   // send(): soketler arasında round-robin
+
+    // Batch başına yeniden kullanılan tamponlar: kararlı durumda gönderim yolu bellek ayırmaz
+    struct BatchScratch {
+        std::vector<uint8_t> headers;
+        std::vector<iovec> iovs;
+        std::vector<mmsghdr> msgs;
+        std::vector<size_t> msg_path;
+        std::vector<size_t> msg_packet;
+        std::vector<size_t> addr_indices;
+        std::vector<uint8_t> controls;
+    };
+    BatchScratch scratch_;
+
+    // Geri bildirim alım tamponları (poll_feedback thread'i)
+    std::vector<pollfd> poll_fds_;
+    alignas(8) uint8_t feedback_buffer_[2048];
+};
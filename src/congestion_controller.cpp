@@ -0,0 +1,179 @@
+#include "congestion_controller.hpp"
+#include <algorithm>
+#include <cmath>
+
+void TrendlineEstimator::update(double send_ms, double arrival_ms) {
+    if (!have_previous_) {
+        previous_send_ms_ = send_ms;
+        previous_arrival_ms_ = arrival_ms;
+        have_previous_ = true;
+        return;
+    }
+
+    const double send_delta_ms = send_ms - previous_send_ms_;
+    if (send_delta_ms <= 0) return;   // reordered or repeated group
+    const double arrival_delta_ms = arrival_ms - previous_arrival_ms_;
+    previous_send_ms_ = send_ms;
+    previous_arrival_ms_ = arrival_ms;
+
+    // Positive when the group spent longer in the network than the one before it
+    num_deltas_ = std::min(num_deltas_ + 1, 1000);
+    if (first_arrival_ms_ < 0) first_arrival_ms_ = arrival_ms;
+    accumulated_delay_ += arrival_delta_ms - send_delta_ms;
+    smoothed_delay_ = SMOOTHING * smoothed_delay_ + (1.0 - SMOOTHING) * accumulated_delay_;
+
+    history_.emplace_back(arrival_ms - first_arrival_ms_, smoothed_delay_);
+    if (history_.size() > WINDOW) history_.pop_front();
+
+    // Least-squares slope of smoothed delay over arrival time
+    double trend = previous_trend_;
+    if (history_.size() == WINDOW) {
+        double mean_x = 0.0, mean_y = 0.0;
+        for (const auto& [x, y] : history_) {
+            mean_x += x;
+            mean_y += y;
+        }
+        mean_x /= WINDOW;
+        mean_y /= WINDOW;
+
+        double numerator = 0.0, denominator = 0.0;
+        for (const auto& [x, y] : history_) {
+            numerator += (x - mean_x) * (y - mean_y);
+            denominator += (x - mean_x) * (x - mean_x);
+        }
+        if (denominator != 0.0) trend = numerator / denominator;
+    }
+
+    detect(trend, send_delta_ms, arrival_ms);
+}
+
+void TrendlineEstimator::detect(double trend, double send_delta_ms, double arrival_ms) {
+    if (num_deltas_ < 2) {
+        state_ = BandwidthUsage::NORMAL;
+        return;
+    }
+
+    modified_trend_ = std::min(num_deltas_, 60) * trend * GAIN;
+    if (modified_trend_ > threshold_) {
+        // Overuse must last a while and keep growing before it counts
+        time_over_using_ms_ = time_over_using_ms_ < 0 ? send_delta_ms / 2 : time_over_using_ms_ + send_delta_ms;
+        overuse_count_++;
+        if (time_over_using_ms_ > OVERUSE_TIME_MS && overuse_count_ > 1 && trend >= previous_trend_) {
+            time_over_using_ms_ = 0;
+            overuse_count_ = 0;
+            state_ = BandwidthUsage::OVERUSING;
+        }
+    } else if (modified_trend_ < -threshold_) {
+        time_over_using_ms_ = -1;
+        overuse_count_ = 0;
+        state_ = BandwidthUsage::UNDERUSING;
+    } else {
+        time_over_using_ms_ = -1;
+        overuse_count_ = 0;
+        state_ = BandwidthUsage::NORMAL;
+    }
+    previous_trend_ = trend;
+    update_threshold(modified_trend_, arrival_ms);
+}
+
+void TrendlineEstimator::update_threshold(double modified_trend, double now_ms) {
+    if (last_threshold_update_ms_ < 0) last_threshold_update_ms_ = now_ms;
+
+    // Spikes (e.g. a route change) must not drag the threshold along
+    const double magnitude = std::fabs(modified_trend);
+    if (magnitude > threshold_ + 15.0) {
+        last_threshold_update_ms_ = now_ms;
+        return;
+    }
+
+    // Follows the trend down quickly and up slowly, so competing TCP flows do not starve us
+    const double k = magnitude < threshold_ ? 0.039 : 0.0087;
+    const double dt_ms = std::min(now_ms - last_threshold_update_ms_, 100.0);
+    threshold_ = std::clamp(threshold_ + k * (magnitude - threshold_) * dt_ms, 6.0, 600.0);
+    last_threshold_update_ms_ = now_ms;
+}
+
+DelayGradientController::DelayGradientController(int initial_bps, int min_bps, int max_bps)
+    : target_bps_(initial_bps), min_bps_(min_bps), max_bps_(max_bps) {
+    target_bps_ = std::clamp(target_bps_, min_bps_, max_bps_);
+}
+
+void DelayGradientController::on_feedback(const CongestionFeedback& feedback) {
+    const double dt_ms = last_update_ms_ < 0 ? 0.0 : static_cast<double>(feedback.now_ms - last_update_ms_);
+    last_update_ms_ = feedback.now_ms;
+
+    if (feedback.loss_fraction >= 0) {
+        loss_fraction_ = loss_fraction_ < 0 ? feedback.loss_fraction
+                                            : loss_fraction_ + LOSS_SMOOTHING * (feedback.loss_fraction - loss_fraction_);
+    }
+
+    for (size_t i = 0; i < feedback.arrival_count; ++i) {
+        trendline_.update(feedback.arrivals[i].send_us / 1000.0, feedback.arrivals[i].arrival_us / 1000.0);
+    }
+    update_delay_based(feedback, dt_ms);
+
+    // Loss-based backoff, at most once per reaction time
+    const double rtt_ms = feedback.rtt_ms > 0 ? feedback.rtt_ms : 100.0;
+    if (loss_fraction_ > LOSS_HIGH &&
+        (last_loss_backoff_ms_ < 0 || feedback.now_ms - last_loss_backoff_ms_ >= LOSS_BACKOFF_INTERVAL_MS + rtt_ms)) {
+        target_bps_ *= 1.0 - 0.5 * loss_fraction_;
+        last_loss_backoff_ms_ = feedback.now_ms;
+    }
+
+    target_bps_ = std::clamp(target_bps_, min_bps_, max_bps_);
+}
+
+void DelayGradientController::update_delay_based(const CongestionFeedback& feedback, double dt_ms) {
+    switch (trendline_.state()) {
+    case BandwidthUsage::OVERUSING:
+        if (rate_state_ != RateState::DECREASE) rate_state_ = RateState::DECREASE;
+        break;
+    case BandwidthUsage::UNDERUSING:
+        rate_state_ = RateState::HOLD;   // queues are draining, let them
+        break;
+    case BandwidthUsage::NORMAL:
+        if (rate_state_ == RateState::HOLD) rate_state_ = RateState::INCREASE;
+        break;
+    }
+
+    // Far more getting through than the last congestion point: the link changed
+    if (link_capacity_bps_ > 0 && feedback.received_bps > 1.5 * link_capacity_bps_) link_capacity_bps_ = -1.0;
+
+    const double rtt_ms = feedback.rtt_ms > 0 ? feedback.rtt_ms : 100.0;
+    switch (rate_state_) {
+    case RateState::HOLD:
+        break;
+
+    case RateState::INCREASE: {
+        if (loss_fraction_ >= LOSS_LOW) break;   // loss says there is no headroom
+
+        double increase;
+        if (link_capacity_bps_ > 0 && target_bps_ >= 0.9 * link_capacity_bps_) {
+            // Near the known capacity: about one packet per response time
+            const double response_ms = rtt_ms + 100.0;
+            increase = std::max(1000.0, PACKET_BITS * 1000.0 / response_ms) * dt_ms / 1000.0;
+        } else {
+            increase = std::max(1000.0, target_bps_ * (std::pow(INCREASE_PER_SECOND, std::min(dt_ms, 1000.0) / 1000.0) - 1.0));
+        }
+
+        // Never run far ahead of what actually arrives (app-limited encoder or a capped link)
+        double increased = target_bps_ + increase;
+        if (feedback.received_bps > 0)
+            increased = std::min(increased, std::max(target_bps_, 1.5 * feedback.received_bps + 10000.0));
+        target_bps_ = increased;
+        break;
+    }
+
+    case RateState::DECREASE: {
+        // One decrease per round trip: the previous one has not shown up in the queue yet
+        if (last_decrease_ms_ >= 0 && feedback.now_ms - last_decrease_ms_ < rtt_ms) break;
+
+        const double basis = feedback.received_bps > 0 ? feedback.received_bps : target_bps_;
+        target_bps_ = std::min(target_bps_, DECREASE_FACTOR * basis);
+        link_capacity_bps_ = link_capacity_bps_ < 0 ? basis : 0.95 * link_capacity_bps_ + 0.05 * basis;
+        last_decrease_ms_ = feedback.now_ms;
+        rate_state_ = RateState::HOLD;
+        break;
+    }
+    }
+}
@@ -24,11 +24,15 @@ void H264Decoder::init() {
 }
 
 bool H264Decoder::decode(const std::vector<uint8_t>& encoded_data, cv::Mat& output_frame) {
+    return decode(encoded_data.data(), encoded_data.size(), output_frame);
+}
+
+bool H264Decoder::decode(const uint8_t* data, size_t size, cv::Mat& output_frame) {
     if (!codec_ctx || !frame || !packet) return false;
 
     av_packet_unref(packet);
-    packet->data = const_cast<uint8_t*>(encoded_data.data());
-    packet->size = encoded_data.size();
+    packet->data = const_cast<uint8_t*>(data);
+    packet->size = size;
 
     if (avcodec_send_packet(codec_ctx, packet) < 0)
         return false;
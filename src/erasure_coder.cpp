@@ -1,15 +1,23 @@
 #include "erasure_coder.hpp"
+#include "gf256.hpp"
 #include <stdexcept>
-#include <jerasure.h>
 #include <reed_sol.h>
 #include <cstring>
 #include <vector>
 #include <iostream>
+#include <algorithm>
 
 ErasureCoder::ErasureCoder(int k, int r, int w)
     : k_(k), r_(r), w_(w) {
+    if (w_ != 8) throw std::runtime_error("ErasureCoder supports only w = 8");
+    if (k_ <= 0 || r_ <= 0 || k_ + r_ > MAX_BLOCKS) throw std::runtime_error("Invalid (k, r) for GF(2^8)");
+
+    // Keep Jerasure's Vandermonde matrix so the wire format stays identical
     matrix_ = reed_sol_vandermonde_coding_matrix(k_, r_, w_);
     if (!matrix_) throw std::runtime_error("Failed to create coding matrix");
+
+    coding_.resize(r_ * k_);
+    for (int i = 0; i < r_ * k_; ++i) coding_[i] = static_cast<uint8_t>(matrix_[i]);
 }
 
 ErasureCoder::~ErasureCoder() {
@@ -25,15 +33,22 @@ void ErasureCoder::encode(const std::vector<std::vector<uint8_t>>& k_chunks,
     out_blocks.assign(k_chunks.begin(), k_chunks.end());
     out_blocks.resize(k_ + r_, std::vector<uint8_t>(block_size, 0));
 
-    std::vector<uint8_t*> data_ptrs(k_);
-    std::vector<uint8_t*> code_ptrs(r_);
-    for (int i = 0; i < k_; ++i) data_ptrs[i] = const_cast<uint8_t*>(k_chunks[i].data());
-    for (int i = 0; i < r_; ++i) code_ptrs[i] = out_blocks[k_ + i].data();
+    const uint8_t* data_ptrs[MAX_BLOCKS];
+    uint8_t* parity_ptrs[MAX_BLOCKS];
+    for (int i = 0; i < k_; ++i) data_ptrs[i] = k_chunks[i].data();
+    for (int i = 0; i < r_; ++i) parity_ptrs[i] = out_blocks[k_ + i].data();
+
+    encode(data_ptrs, parity_ptrs, block_size);
+}
 
-    jerasure_matrix_encode(k_, r_, w_, matrix_,
-                           reinterpret_cast<char**>(data_ptrs.data()),
-                           reinterpret_cast<char**>(code_ptrs.data()),
-                           block_size);
+void ErasureCoder::encode(const uint8_t* const* data, uint8_t* const* parity, size_t block_size) {
+    // parity[i] = sum_j coding[i][j] * data[j]
+    for (int i = 0; i < r_; ++i) {
+        const uint8_t* row = &coding_[i * k_];
+        gf256_mul_region(row[0], data[0], parity[i], block_size);
+        for (int j = 1; j < k_; ++j)
+            gf256_mul_add_region(row[j], data[j], parity[i], block_size);
+    }
 }
 
 bool ErasureCoder::decode(const std::vector<std::vector<uint8_t>>& blocks,
@@ -48,70 +63,106 @@ bool ErasureCoder::decode(const std::vector<std::vector<uint8_t>>& blocks,
         return false;
     }
 
-    size_t block_size = blocks[0].size();
-    
-    // Count received blocks
-    int received_count = 0;
-    for (bool r : received) if (r) received_count++;
-    
+    // Missing blocks may be empty, so take the size from a received one
+    size_t block_size = 0;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        if (received[i]) block_size = std::max(block_size, blocks[i].size());
+    }
+
+    std::vector<uint8_t> matrix(blocks.size() * block_size, 0);
+    uint8_t* block_ptrs[MAX_BLOCKS];
+    uint64_t received_mask = 0;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        block_ptrs[i] = matrix.data() + i * block_size;
+        if (received[i]) {
+            std::copy(blocks[i].begin(), blocks[i].end(), block_ptrs[i]);
+            received_mask |= uint64_t(1) << i;
+        }
+    }
+
+    if (!decode_in_place(block_ptrs, received_mask, block_size)) return false;
+
+    recovered_data.assign(matrix.begin(), matrix.begin() + k_ * block_size);
+    return true;
+}
+
+bool ErasureCoder::decode_in_place(uint8_t* const* blocks, uint64_t received_mask, size_t block_size) {
+    const uint64_t all_blocks = (k_ + r_ == 64) ? ~uint64_t(0) : (uint64_t(1) << (k_ + r_)) - 1;
+    const uint64_t data_blocks = (uint64_t(1) << k_) - 1;
+    received_mask &= all_blocks;
+
+    // Lossless: data blocks are already in place
+    if ((received_mask & data_blocks) == data_blocks) return true;
+
+    int received_count = __builtin_popcountll(received_mask);
     if (received_count < k_) {
         std::cerr << "[FEC] Not enough blocks received: " << received_count << " < " << k_ << std::endl;
         return false;
     }
 
-    // Create working copies of the blocks
-    std::vector<std::vector<uint8_t>> working_blocks = blocks;
-    
-    // Prepare data and parity pointers
-    std::vector<uint8_t*> data_ptrs(k_);
-    std::vector<uint8_t*> code_ptrs(r_);
-    
-    for (int i = 0; i < k_; ++i) {
-        data_ptrs[i] = working_blocks[i].data();
+    // Decoding matrix rows: the first k received blocks, expressed over the data blocks
+    int rows[MAX_BLOCKS];
+    int row_count = 0;
+    uint64_t row_mask = 0;
+    for (int i = 0; i < k_ + r_ && row_count < k_; ++i) {
+        if (received_mask & (uint64_t(1) << i)) {
+            rows[row_count++] = i;
+            row_mask |= uint64_t(1) << i;
+        }
     }
-    for (int i = 0; i < r_; ++i) {
-        code_ptrs[i] = working_blocks[k_ + i].data();
+
+    uint8_t inv[MAX_BLOCKS * MAX_BLOCKS];
+    if (!decoding_matrix(row_mask, rows, inv)) {
+        std::cerr << "[FEC] Decode failed: singular decoding matrix" << std::endl;
+        return false;
     }
 
-    // Build erasure list
-    std::vector<int> erasures;
-    for (int i = 0; i < k_ + r_; ++i) {
-        if (!received[i]) {
-            erasures.push_back(i);
-        }
+    // data[j] = sum_t inv[j][t] * block[rows[t]], only for the erased data blocks
+    for (int j = 0; j < k_; ++j) {
+        if (received_mask & (uint64_t(1) << j)) continue;
+        const uint8_t* row = &inv[j * k_];
+        gf256_mul_region(row[0], blocks[rows[0]], blocks[j], block_size);
+        for (int t = 1; t < k_; ++t)
+            gf256_mul_add_region(row[t], blocks[rows[t]], blocks[j], block_size);
     }
-    erasures.push_back(-1); // terminator
-
-    // If no erasures, just return the data blocks
-    if (erasures.size() == 1) {
-        recovered_data.clear();
-        for (int i = 0; i < k_; ++i) {
-            recovered_data.insert(recovered_data.end(), 
-                                working_blocks[i].begin(), 
-                                working_blocks[i].end());
+
+    return true;
+}
+
+bool ErasureCoder::decoding_matrix(uint64_t row_mask, const int* rows, uint8_t* inv) {
+    const size_t n = k_ * k_;
+
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        auto it = cache_index_.find(row_mask);
+        if (it != cache_index_.end()) {
+            cache_lru_.splice(cache_lru_.begin(), cache_lru_, it->second);
+            std::copy_n(it->second->second.begin(), n, inv);
+            cache_hits_++;
+            return true;
         }
-        return true;
     }
+    cache_misses_++;
 
-    // Perform Reed-Solomon decoding
-    int ret = jerasure_matrix_decode(k_, r_, w_, matrix_, 0, erasures.data(),
-                                     reinterpret_cast<char**>(data_ptrs.data()),
-                                     reinterpret_cast<char**>(code_ptrs.data()),
-                                     block_size);
-    
-    if (ret < 0) {
-        std::cerr << "[FEC] Decode failed with error: " << ret << std::endl;
-        return false;
+    std::vector<uint8_t> dm(n, 0);
+    for (int t = 0; t < k_; ++t) {
+        if (rows[t] < k_) dm[t * k_ + rows[t]] = 1;
+        else std::copy_n(&coding_[(rows[t] - k_) * k_], k_, &dm[t * k_]);
     }
 
-    // Extract recovered data
-    recovered_data.clear();
-    for (int i = 0; i < k_; ++i) {
-        recovered_data.insert(recovered_data.end(), 
-                            working_blocks[i].begin(), 
-                            working_blocks[i].end());
+    if (!gf256_invert_matrix(dm.data(), inv, k_)) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        if (cache_index_.find(row_mask) == cache_index_.end()) {
+            cache_lru_.emplace_front(row_mask, std::vector<uint8_t>(inv, inv + n));
+            cache_index_[row_mask] = cache_lru_.begin();
+            if (cache_lru_.size() > DECODE_CACHE_CAPACITY) {
+                cache_index_.erase(cache_lru_.back().first);
+                cache_lru_.pop_back();
+            }
+        }
     }
-    
+
     return true;
 }
-
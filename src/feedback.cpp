@@ -0,0 +1,155 @@
+#include "feedback.hpp"
+#include <cstring>
+#include <algorithm>
+// Paket formatı: bkz. feedback.hpp
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+static void swap_entry(NackEntry& e) {
+    e.frame_id = __builtin_bswap32(e.frame_id);
+    e.group_index = __builtin_bswap16(e.group_index);
+    e.budget_ms = __builtin_bswap16(e.budget_ms);
+    e.missing_mask = __builtin_bswap64(e.missing_mask);
+}
+
+static void swap_report(ReceiverReport& r) {
+    r.highest_frame_id = __builtin_bswap32(r.highest_frame_id);
+    r.played_frame_id = __builtin_bswap32(r.played_frame_id);
+    r.echo_timestamp_us = static_cast<int64_t>(__builtin_bswap64(static_cast<uint64_t>(r.echo_timestamp_us)));
+    r.hold_us = __builtin_bswap32(r.hold_us);
+    r.echo_port = __builtin_bswap16(r.echo_port);
+    r.frame_loss_mask = __builtin_bswap64(r.frame_loss_mask);
+}
+
+static void swap_path(ReportPath& p) {
+    p.port = __builtin_bswap16(p.port);
+    p.received = __builtin_bswap32(p.received);
+}
+
+static void swap_arrival(ArrivalSample& a) {
+    a.send_us = static_cast<int64_t>(__builtin_bswap64(static_cast<uint64_t>(a.send_us)));
+    a.arrival_us = static_cast<int64_t>(__builtin_bswap64(static_cast<uint64_t>(a.arrival_us)));
+}
+#else
+static void swap_entry(NackEntry&) {}
+static void swap_report(ReceiverReport&) {}
+static void swap_path(ReportPath&) {}
+static void swap_arrival(ArrivalSample&) {}
+#endif
+
+uint8_t feedback_type(const uint8_t* data, size_t len) {
+    if (len < 1) return 0;
+    return data[0] == FEEDBACK_NACK || data[0] == FEEDBACK_REPORT ? data[0] : 0;
+}
+
+size_t write_nack(const NackEntry* entries, size_t count, uint8_t* out) {
+    if (count > MAX_NACK_ENTRIES) count = MAX_NACK_ENTRIES;
+
+    out[0] = FEEDBACK_NACK;
+    out[1] = static_cast<uint8_t>(count);
+    out[2] = 0;
+    out[3] = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        NackEntry wire = entries[i];
+        swap_entry(wire);
+        std::memcpy(out + NACK_HEADER_SIZE + i * sizeof(NackEntry), &wire, sizeof(NackEntry));
+    }
+    return NACK_HEADER_SIZE + count * sizeof(NackEntry);
+}
+
+bool parse_nack(const uint8_t* data, size_t len, std::vector<NackEntry>& entries) {
+    if (len < NACK_HEADER_SIZE || data[0] != FEEDBACK_NACK) return false;
+
+    size_t count = data[1];
+    if (count > MAX_NACK_ENTRIES || len != NACK_HEADER_SIZE + count * sizeof(NackEntry)) return false;
+
+    entries.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::memcpy(&entries[i], data + NACK_HEADER_SIZE + i * sizeof(NackEntry), sizeof(NackEntry));
+        swap_entry(entries[i]);
+    }
+    return true;
+}
+
+size_t write_receiver_report(const ReceiverReport& report,
+                             const ReportPath* paths, size_t path_count,
+                             const ArrivalSample* arrivals, size_t arrival_count, uint8_t* out) {
+    if (path_count > MAX_REPORT_PATHS) path_count = MAX_REPORT_PATHS;
+    if (arrival_count > MAX_REPORT_ARRIVALS) arrival_count = MAX_REPORT_ARRIVALS;
+
+    out[0] = FEEDBACK_REPORT;
+    out[1] = static_cast<uint8_t>(path_count);
+    out[2] = static_cast<uint8_t>(arrival_count);
+    out[3] = 0;
+
+    ReceiverReport wire = report;
+    swap_report(wire);
+    std::memcpy(out + REPORT_HEADER_SIZE, &wire, sizeof(wire));
+
+    uint8_t* p = out + REPORT_HEADER_SIZE + sizeof(ReceiverReport);
+    for (size_t i = 0; i < path_count; ++i, p += sizeof(ReportPath)) {
+        ReportPath path = paths[i];
+        swap_path(path);
+        std::memcpy(p, &path, sizeof(ReportPath));
+    }
+    for (size_t i = 0; i < arrival_count; ++i, p += sizeof(ArrivalSample)) {
+        ArrivalSample arrival = arrivals[i];
+        swap_arrival(arrival);
+        std::memcpy(p, &arrival, sizeof(ArrivalSample));
+    }
+    return static_cast<size_t>(p - out);
+}
+
+bool parse_receiver_report(const uint8_t* data, size_t len, ReceiverReport& report,
+                           std::vector<ReportPath>& paths, std::vector<ArrivalSample>& arrivals) {
+    if (len < REPORT_HEADER_SIZE + sizeof(ReceiverReport) || data[0] != FEEDBACK_REPORT) return false;
+
+    size_t path_count = data[1];
+    size_t arrival_count = data[2];
+    if (path_count > MAX_REPORT_PATHS || arrival_count > MAX_REPORT_ARRIVALS ||
+        len != REPORT_HEADER_SIZE + sizeof(ReceiverReport) +
+               path_count * sizeof(ReportPath) + arrival_count * sizeof(ArrivalSample))
+        return false;
+
+    std::memcpy(&report, data + REPORT_HEADER_SIZE, sizeof(report));
+    swap_report(report);
+
+    const uint8_t* p = data + REPORT_HEADER_SIZE + sizeof(ReceiverReport);
+    paths.resize(path_count);
+    for (size_t i = 0; i < path_count; ++i, p += sizeof(ReportPath)) {
+        std::memcpy(&paths[i], p, sizeof(ReportPath));
+        swap_path(paths[i]);
+    }
+    arrivals.resize(arrival_count);
+    for (size_t i = 0; i < arrival_count; ++i, p += sizeof(ArrivalSample)) {
+        std::memcpy(&arrivals[i], p, sizeof(ArrivalSample));
+        swap_arrival(arrivals[i]);
+    }
+    return true;
+}
+
+void ArrivalGroups::on_packet(int64_t send_us, int64_t arrival_us) {
+    if (have_group_) {
+        // Reordered across groups: the previous group is already closed
+        if (send_us < group_start_us_) return;
+        if (send_us - group_start_us_ <= GROUP_SPAN_US) {
+            // The group is represented by its last packet
+            if (send_us >= current_.send_us) current_.send_us = send_us;
+            if (arrival_us > current_.arrival_us) current_.arrival_us = arrival_us;
+            return;
+        }
+        if (done_.size() == MAX_REPORT_ARRIVALS) done_.erase(done_.begin());
+        done_.push_back(current_);
+    }
+    current_.send_us = send_us;
+    current_.arrival_us = arrival_us;
+    group_start_us_ = send_us;
+    have_group_ = true;
+}
+
+size_t ArrivalGroups::take(ArrivalSample* out, size_t max) {
+    size_t count = std::min(max, done_.size());
+    std::copy(done_.end() - count, done_.end(), out);
+    done_.clear();
+    return count;
+}
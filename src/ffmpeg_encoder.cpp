@@ -4,6 +4,8 @@
 #include <thread>
 #include <opencv2/imgproc.hpp>
 
+static constexpr int FRAME_ALIGN = 32;   // plane alignment for the SIMD paths in libswscale/x264
+
 FFmpegEncoder::FFmpegEncoder(int width, int height, int fps, int bitrate)
     : m_width(width), m_height(height), m_fps(fps), m_bitrate(bitrate)
 {
@@ -54,12 +56,14 @@ void FFmpegEncoder::initEncoder() {
     if (!frame || !pkt)
         throw std::runtime_error("Failed to allocate frame or packet");
 
-    frame->format = codecContext->pix_fmt;
-    frame->width = codecContext->width;
-    frame->height = codecContext->height;
-
-    if (av_frame_get_buffer(frame, 32) < 0)
-        throw std::runtime_error("Could not allocate frame buffer");
+    // With frame threading the codec keeps a reference to each submitted frame for a while,
+    // so every frame gets its own pooled buffer instead of one buffer rewritten in place
+    int frameBytes = av_image_get_buffer_size(AV_PIX_FMT_YUV420P, m_width, m_height, FRAME_ALIGN);
+    if (frameBytes < 0)
+        throw std::runtime_error("Invalid frame size");
+    framePool = av_buffer_pool_init(frameBytes, nullptr);
+    if (!framePool)
+        throw std::runtime_error("Could not allocate frame buffer pool");
 
     swsCtx = sws_getContext(
         m_width, m_height, AV_PIX_FMT_BGR24,
@@ -72,11 +76,10 @@ void FFmpegEncoder::initEncoder() {
 }
 
 // Calculate scene complexity for dynamic compression
-double FFmpegEncoder::calculateSceneComplexity(const cv::Mat& bgrFrame) {
-    if (bgrFrame.empty()) return 0.0;
+double FFmpegEncoder::calculateSceneComplexity(const cv::Mat& gray) {
+    if (gray.empty()) return 0.0;
     
-    cv::Mat gray, edges;
-    cv::cvtColor(bgrFrame, gray, cv::COLOR_BGR2GRAY);
+    cv::Mat edges;
     
     // Calculate edge density as complexity measure
     cv::Canny(gray, edges, 50, 150);
@@ -92,12 +95,31 @@ double FFmpegEncoder::calculateSceneComplexity(const cv::Mat& bgrFrame) {
     return std::min(complexity, 1.0); // Normalize to [0,1]
 }
 
-bool FFmpegEncoder::encodeFrame(const cv::Mat& bgrFrame, std::vector<uint8_t>& outEncodedData) {
-    if (!codecContext || !frame || !pkt || bgrFrame.empty())
+bool FFmpegEncoder::acquireInputFrame() {
+    av_frame_unref(frame);
+    frame->buf[0] = av_buffer_pool_get(framePool);
+    if (!frame->buf[0])
+        return false;
+    frame->format = AV_PIX_FMT_YUV420P;
+    frame->width = m_width;
+    frame->height = m_height;
+    return av_image_fill_arrays(frame->data, frame->linesize, frame->buf[0]->data,
+                                AV_PIX_FMT_YUV420P, m_width, m_height, FRAME_ALIGN) >= 0;
+}
+
+bool FFmpegEncoder::encodeFrame(const cv::Mat& inputFrame, std::vector<uint8_t>& outEncodedData) {
+    if (!codecContext || !frame || !pkt || inputFrame.empty())
         return false;
 
-    // Calculate scene complexity and adjust encoding parameters
-    double complexity = calculateSceneComplexity(bgrFrame);
+    const bool i420 = inputFrame.type() == CV_8UC1;
+    if (i420 && (inputFrame.cols != m_width || inputFrame.rows != m_height * 3 / 2 || !inputFrame.isContinuous()))
+        return false;
+
+    // Calculate scene complexity and adjust encoding parameters (I420 already has a luma plane)
+    cv::Mat gray;
+    if (i420) gray = inputFrame.rowRange(0, m_height);
+    else cv::cvtColor(inputFrame, gray, cv::COLOR_BGR2GRAY);
+    double complexity = calculateSceneComplexity(gray);
     
     // Dynamic compression based on scene complexity
     if (complexity > 0.7) {
@@ -114,13 +136,29 @@ bool FFmpegEncoder::encodeFrame(const cv::Mat& bgrFrame, std::vector<uint8_t>& o
         av_opt_set(codecContext->priv_data, "preset", "ultrafast", 0);
     }
 
-    const uint8_t* inData[1] = { bgrFrame.data };
-    int inLinesize[1] = { static_cast<int>(bgrFrame.step) };
-
-    sws_scale(swsCtx, inData, inLinesize, 0, m_height, frame->data, frame->linesize);
+    // The caller's memory (a capture slot, an mmap'd file) is never handed to the codec: it may
+    // hold the frame past this call, after the caller has reused or unmapped it
+    if (!acquireInputFrame())
+        return false;
+    if (i420) {
+        // Planes are already YUV420P: one copy into the pooled frame, no colour conversion
+        const int lumaSize = m_width * m_height;
+        const uint8_t* planes[3] = { inputFrame.data, inputFrame.data + lumaSize,
+                                     inputFrame.data + lumaSize + lumaSize / 4 };
+        av_image_copy_plane(frame->data[0], frame->linesize[0], planes[0], m_width, m_width, m_height);
+        av_image_copy_plane(frame->data[1], frame->linesize[1], planes[1], m_width / 2, m_width / 2, m_height / 2);
+        av_image_copy_plane(frame->data[2], frame->linesize[2], planes[2], m_width / 2, m_width / 2, m_height / 2);
+    } else {
+        const uint8_t* inData[1] = { inputFrame.data };
+        int inLinesize[1] = { static_cast<int>(inputFrame.step) };
+        sws_scale(swsCtx, inData, inLinesize, 0, m_height, frame->data, frame->linesize);
+    }
     frame->pts = frameCounter++;
 
-    if (avcodec_send_frame(codecContext, frame) < 0)
+    // The codec takes its own reference if it needs the frame later
+    int sent = avcodec_send_frame(codecContext, frame);
+    av_frame_unref(frame);
+    if (sent < 0)
         return false;
 
     int ret = avcodec_receive_packet(codecContext, pkt);
@@ -157,6 +195,8 @@ void FFmpegEncoder::cleanup() {
     if (codecContext) avcodec_free_context(&codecContext);
     if (frame) av_frame_free(&frame);
     if (pkt) av_packet_free(&pkt);
+    // Buffers still referenced elsewhere are freed when released
+    if (framePool) av_buffer_pool_uninit(&framePool);
     if (swsCtx) sws_freeContext(swsCtx);
 }
 
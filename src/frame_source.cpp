@@ -0,0 +1,270 @@
+#include "frame_source.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <sstream>
+
+static std::string size_string(int width, int height, int fps) {
+    std::ostringstream out;
+    out << width << "x" << height << "@" << fps;
+    return out.str();
+}
+
+static void check_i420_size(int width, int height) {
+    if (width <= 0 || height <= 0 || width % 2 || height % 2)
+        throw std::runtime_error("I420 frames need a positive, even width and height");
+}
+
+static bool ends_with(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// ---------------------------------------------------------------------------
+// CameraSource
+
+CameraSource::CameraSource(int device, int width, int height, int fps)
+    : capture_(device, cv::CAP_V4L2), device_(device), width_(width), height_(height), fps_(fps) {
+    capture_.set(cv::CAP_PROP_FRAME_WIDTH, width);
+    capture_.set(cv::CAP_PROP_FRAME_HEIGHT, height);
+    capture_.set(cv::CAP_PROP_FPS, fps);
+    if (!capture_.isOpened())
+        throw std::runtime_error("Camera could not be started");
+
+    // The driver may pick the nearest mode it supports; the encoder has to match it
+    int actual_width = static_cast<int>(capture_.get(cv::CAP_PROP_FRAME_WIDTH));
+    int actual_height = static_cast<int>(capture_.get(cv::CAP_PROP_FRAME_HEIGHT));
+    if (actual_width > 0 && actual_height > 0) {
+        width_ = actual_width;
+        height_ = actual_height;
+    }
+}
+
+std::string CameraSource::describe() const {
+    return "camera /dev/video" + std::to_string(device_) + " " + size_string(width_, height_, fps_);
+}
+
+// ---------------------------------------------------------------------------
+// SyntheticSource
+
+SyntheticSource::SyntheticSource(int width, int height, int fps, double complexity, uint32_t seed)
+    : width_(width), height_(height), fps_(fps),
+      complexity_(std::min(std::max(complexity, 0.0), 1.0)), seed_(seed ? seed : 1) {
+    check_i420_size(width, height);
+}
+
+// Per-row noise stream: a function of (seed, frame, row) only, so every run and
+// every machine produces the same frames
+static uint32_t row_seed(uint32_t seed, uint64_t frame, int row) {
+    uint64_t h = (frame * 0x9E3779B97F4A7C15ull) ^ (static_cast<uint64_t>(row) * 0xC2B2AE3D27D4EB4Full) ^ seed;
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 32;
+    return static_cast<uint32_t>(h) | 1;
+}
+
+static inline uint32_t xorshift32(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Triangle wave in [0, span]: position of the bouncing square
+static int bounce(uint64_t t, int span) {
+    if (span <= 0) return 0;
+    uint64_t period = static_cast<uint64_t>(span) * 2;
+    int p = static_cast<int>(t % period);
+    return p <= span ? p : static_cast<int>(period) - p;
+}
+
+bool SyntheticSource::read(cv::Mat& frame) {
+    const int w = width_;
+    const int h = height_;
+    frame.create(h * 3 / 2, w, CV_8UC1);
+
+    const uint64_t t = frame_index_++;
+    // Ramp slope in 1/16 steps and noise amplitude both grow with complexity
+    const int slope_q4 = 16 + static_cast<int>(complexity_ * 48);
+    const int noise = static_cast<int>(complexity_ * 48);
+    const int shift = static_cast<int>(t * 4);
+
+    const int square = std::max(h / 4, 2);
+    const int square_x = bounce(t * 3, w - square);
+    const int square_y = bounce(t * 2, h - square);
+
+    uint8_t* luma = frame.data;
+    for (int y = 0; y < h; ++y) {
+        uint8_t* row = luma + static_cast<size_t>(y) * w;
+        uint32_t rng = row_seed(seed_, t, y);
+        const bool square_row = y >= square_y && y < square_y + square;
+        for (int x = 0; x < w; ++x) {
+            int v = ((x + y) * slope_q4 / 16 + shift) & 0xFF;
+            if (square_row && x >= square_x && x < square_x + square) v = 255 - v;
+            if (noise > 0) v += static_cast<int>(xorshift32(rng) & 0xFF) * noise / 256 - noise / 2;
+            row[x] = static_cast<uint8_t>(std::min(std::max(v, 0), 255));
+        }
+    }
+
+    // Chroma: slow horizontal (U) and vertical (V) gradients drifting in opposite directions
+    const int cw = w / 2;
+    const int ch = h / 2;
+    uint8_t* u_plane = luma + static_cast<size_t>(w) * h;
+    uint8_t* v_plane = u_plane + static_cast<size_t>(cw) * ch;
+    for (int y = 0; y < ch; ++y) {
+        uint8_t* u_row = u_plane + static_cast<size_t>(y) * cw;
+        uint8_t* v_row = v_plane + static_cast<size_t>(y) * cw;
+        const int v_value = 96 + ((y * 2 - static_cast<int>(t)) & 63);
+        for (int x = 0; x < cw; ++x) {
+            u_row[x] = static_cast<uint8_t>(96 + ((x * 2 + static_cast<int>(t)) & 63));
+            v_row[x] = static_cast<uint8_t>(v_value);
+        }
+    }
+    return true;
+}
+
+std::string SyntheticSource::describe() const {
+    std::ostringstream out;
+    out << "synthetic " << size_string(width_, height_, fps_) << ", complexity " << complexity_;
+    return out.str();
+}
+
+// ---------------------------------------------------------------------------
+// FileSource
+
+FileSource::FileSource(const std::string& path, int width, int height, int fps, bool loop)
+    : path_(path), width_(width), height_(height), fps_(fps), loop_(loop) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+        ::close(fd);
+        throw std::runtime_error("Empty or unreadable file: " + path);
+    }
+    map_size_ = static_cast<size_t>(st.st_size);
+
+    void* map = mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+        throw std::runtime_error("mmap failed for " + path + ": " + std::strerror(errno));
+    map_ = static_cast<const uint8_t*>(map);
+
+    // Read ahead now so the first pass does not stall the capture thread on page faults
+    madvise(map, map_size_, MADV_WILLNEED);
+
+    try {
+        if (ends_with(path, ".y4m")) parse_y4m();
+        else index_raw();
+    } catch (...) {
+        munmap(const_cast<uint8_t*>(map_), map_size_);
+        throw;
+    }
+}
+
+FileSource::~FileSource() {
+    if (map_) munmap(const_cast<uint8_t*>(map_), map_size_);
+}
+
+void FileSource::parse_y4m() {
+    static const char MAGIC[] = "YUV4MPEG2 ";
+    const size_t magic_len = sizeof(MAGIC) - 1;
+    if (map_size_ < magic_len || std::memcmp(map_, MAGIC, magic_len) != 0)
+        throw std::runtime_error(path_ + " is not a YUV4MPEG2 file");
+
+    const uint8_t* end = map_ + map_size_;
+    const uint8_t* line_end = static_cast<const uint8_t*>(std::memchr(map_, '\n', map_size_));
+    if (!line_end)
+        throw std::runtime_error(path_ + ": truncated Y4M header");
+
+    const char* header_begin = reinterpret_cast<const char*>(map_) + magic_len;
+    std::istringstream header(std::string(header_begin, reinterpret_cast<const char*>(line_end)));
+    std::string token;
+    while (header >> token) {
+        switch (token[0]) {
+        case 'W': width_ = std::atoi(token.c_str() + 1); break;
+        case 'H': height_ = std::atoi(token.c_str() + 1); break;
+        case 'F': {
+            int num = 0, den = 0;
+            if (std::sscanf(token.c_str() + 1, "%d:%d", &num, &den) == 2 && num > 0 && den > 0)
+                fps_ = std::max(1, static_cast<int>(std::lround(static_cast<double>(num) / den)));
+            break;
+        }
+        case 'C':
+            if (token.compare(1, 3, "420") != 0)
+                throw std::runtime_error(path_ + ": only 4:2:0 Y4M is supported (got " + token + ")");
+            break;
+        default:
+            break;   // interlacing, aspect ratio, comments: irrelevant here
+        }
+    }
+    check_i420_size(width_, height_);
+    frame_size_ = static_cast<size_t>(width_) * height_ * 3 / 2;
+
+    // Every frame is "FRAME[ params]\n" followed by the planes; a truncated last frame is ignored
+    const uint8_t* p = line_end + 1;
+    while (end - p >= 5 && std::memcmp(p, "FRAME", 5) == 0) {
+        const uint8_t* data = static_cast<const uint8_t*>(std::memchr(p, '\n', end - p));
+        if (!data || static_cast<size_t>(end - data - 1) < frame_size_) break;
+        frames_.push_back(static_cast<size_t>(data + 1 - map_));
+        p = data + 1 + frame_size_;
+    }
+    if (frames_.empty())
+        throw std::runtime_error(path_ + ": no complete frames");
+}
+
+void FileSource::index_raw() {
+    check_i420_size(width_, height_);
+    frame_size_ = static_cast<size_t>(width_) * height_ * 3 / 2;
+    size_t count = map_size_ / frame_size_;
+    if (count == 0)
+        throw std::runtime_error(path_ + ": smaller than one " + std::to_string(width_) + "x" +
+                                 std::to_string(height_) + " I420 frame");
+    for (size_t i = 0; i < count; ++i) frames_.push_back(i * frame_size_);
+}
+
+bool FileSource::read(cv::Mat& frame) {
+    if (next_ == frames_.size()) {
+        if (!loop_) return false;
+        next_ = 0;
+    }
+    // A header over the mapping: no copy, valid for the lifetime of the source
+    frame = cv::Mat(height_ * 3 / 2, width_, CV_8UC1, const_cast<uint8_t*>(map_ + frames_[next_++]));
+    return true;
+}
+
+std::string FileSource::describe() const {
+    return "file " + path_ + " " + size_string(width_, height_, fps_) + ", " +
+           std::to_string(frames_.size()) + " frames" + (loop_ ? ", looping" : "");
+}
+
+// ---------------------------------------------------------------------------
+
+std::unique_ptr<FrameSource> open_frame_source(const std::string& spec, int width, int height, int fps) {
+    const size_t colon = spec.find(':');
+    const std::string kind = spec.substr(0, colon);
+    const std::string arg = colon == std::string::npos ? "" : spec.substr(colon + 1);
+
+    try {
+        if (kind == "camera")
+            return std::make_unique<CameraSource>(arg.empty() ? 0 : std::stoi(arg), width, height, fps);
+        if (kind == "synthetic")
+            return std::make_unique<SyntheticSource>(width, height, fps, arg.empty() ? 0.5 : std::stod(arg));
+    } catch (const std::logic_error&) {
+        // std::stoi / std::stod on a malformed argument
+        throw std::runtime_error("Invalid frame source: " + spec);
+    }
+    if (ends_with(spec, ".y4m") || ends_with(spec, ".yuv"))
+        return std::make_unique<FileSource>(spec, width, height, fps);
+
+    throw std::runtime_error("Unknown frame source: " + spec +
+                             " (expected camera[:N], synthetic[:complexity], *.y4m or *.yuv)");
+}
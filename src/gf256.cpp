@@ -0,0 +1,272 @@
+#include "gf256.hpp"
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NOVA_GF256_X86 1
+#endif
+
+constexpr unsigned GF256_POLY = 0x11D;
+
+namespace {
+
+struct Gf256Tables {
+    uint8_t exp[512];
+    uint8_t log[256];
+    uint8_t mul[256][256];
+    uint8_t lo[256][16];   // c * (x & 0x0F)
+    uint8_t hi[256][16];   // c * (x & 0xF0)
+
+    Gf256Tables() {
+        unsigned x = 1;
+        for (int i = 0; i < 255; ++i) {
+            exp[i] = static_cast<uint8_t>(x);
+            log[x] = static_cast<uint8_t>(i);
+            x <<= 1;
+            if (x & 0x100) x ^= GF256_POLY;
+        }
+        for (int i = 255; i < 512; ++i) exp[i] = exp[i - 255];
+        log[0] = 0;
+
+        for (int a = 0; a < 256; ++a) {
+            for (int b = 0; b < 256; ++b) {
+                mul[a][b] = (a && b) ? exp[log[a] + log[b]] : 0;
+            }
+            for (int n = 0; n < 16; ++n) {
+                lo[a][n] = mul[a][n];
+                hi[a][n] = mul[a][n << 4];
+            }
+        }
+    }
+};
+
+const Gf256Tables& tables() {
+    static const Gf256Tables t;
+    return t;
+}
+
+// ---------------------- Scalar ----------------------
+
+void mul_add_scalar(uint8_t c, const uint8_t* src, uint8_t* dst, size_t len) {
+    const uint8_t* row = tables().mul[c];
+    for (size_t i = 0; i < len; ++i) dst[i] ^= row[src[i]];
+}
+
+void mul_scalar(uint8_t c, const uint8_t* src, uint8_t* dst, size_t len) {
+    const uint8_t* row = tables().mul[c];
+    for (size_t i = 0; i < len; ++i) dst[i] = row[src[i]];
+}
+
+#ifdef NOVA_GF256_X86
+
+// ---------------------- SSSE3 ----------------------
+
+template <bool Accumulate>
+__attribute__((target("ssse3")))
+void region_ssse3(uint8_t c, const uint8_t* src, uint8_t* dst, size_t len) {
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables().lo[c]));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables().hi[c]));
+    const __m128i mask = _mm_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i l = _mm_and_si128(s, mask);
+        __m128i h = _mm_and_si128(_mm_srli_epi64(s, 4), mask);
+        __m128i p = _mm_xor_si128(_mm_shuffle_epi8(lo, l), _mm_shuffle_epi8(hi, h));
+        if (Accumulate)
+            p = _mm_xor_si128(p, _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), p);
+    }
+
+    if (Accumulate) mul_add_scalar(c, src + i, dst + i, len - i);
+    else mul_scalar(c, src + i, dst + i, len - i);
+}
+
+// ---------------------- AVX2 ----------------------
+
+template <bool Accumulate>
+__attribute__((target("avx2")))
+void region_avx2(uint8_t c, const uint8_t* src, uint8_t* dst, size_t len) {
+    const __m256i lo = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables().lo[c])));
+    const __m256i hi = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables().hi[c])));
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i l = _mm256_and_si256(s, mask);
+        __m256i h = _mm256_and_si256(_mm256_srli_epi64(s, 4), mask);
+        __m256i p = _mm256_xor_si256(_mm256_shuffle_epi8(lo, l), _mm256_shuffle_epi8(hi, h));
+        if (Accumulate)
+            p = _mm256_xor_si256(p, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), p);
+    }
+
+    if (Accumulate) mul_add_scalar(c, src + i, dst + i, len - i);
+    else mul_scalar(c, src + i, dst + i, len - i);
+}
+
+// ---------------------- AVX-512BW ----------------------
+
+template <bool Accumulate>
+__attribute__((target("avx512f,avx512bw")))
+void region_avx512(uint8_t c, const uint8_t* src, uint8_t* dst, size_t len) {
+    // GCC 12 builds the unmasked broadcast/shift intrinsics on _mm512_undefined_epi32() and
+    // warns under -Wall; the zero-masked and 16-bit forms don't, and compile to the same code
+    const __m512i lo = _mm512_maskz_broadcast_i32x4(0xFFFF,
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables().lo[c])));
+    const __m512i hi = _mm512_maskz_broadcast_i32x4(0xFFFF,
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables().hi[c])));
+    const __m512i mask = _mm512_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512i s = _mm512_loadu_si512(src + i);
+        __m512i l = _mm512_and_si512(s, mask);
+        __m512i h = _mm512_and_si512(_mm512_srli_epi16(s, 4), mask);
+        __m512i p = _mm512_xor_si512(_mm512_shuffle_epi8(lo, l), _mm512_shuffle_epi8(hi, h));
+        if (Accumulate)
+            p = _mm512_xor_si512(p, _mm512_loadu_si512(dst + i));
+        _mm512_storeu_si512(dst + i, p);
+    }
+
+    if (Accumulate) mul_add_scalar(c, src + i, dst + i, len - i);
+    else mul_scalar(c, src + i, dst + i, len - i);
+}
+
+#endif // NOVA_GF256_X86
+
+// ---------------------- Runtime dispatch ----------------------
+
+using RegionFn = void (*)(uint8_t, const uint8_t*, uint8_t*, size_t);
+
+struct Gf256Kernels {
+    RegionFn mul_add = mul_add_scalar;
+    RegionFn mul = mul_scalar;
+    const char* name = "scalar";
+
+    Gf256Kernels() {
+        for (const char* best : {"avx512", "avx2", "ssse3"}) {
+            if (select(best)) break;
+        }
+    }
+
+    bool select(const char* backend) {
+        if (std::strcmp(backend, "scalar") == 0) {
+            mul_add = mul_add_scalar;
+            mul = mul_scalar;
+            name = "scalar";
+            return true;
+        }
+#ifdef NOVA_GF256_X86
+        __builtin_cpu_init();
+        if (std::strcmp(backend, "avx512") == 0 && __builtin_cpu_supports("avx512bw")) {
+            mul_add = region_avx512<true>;
+            mul = region_avx512<false>;
+            name = "avx512";
+            return true;
+        }
+        if (std::strcmp(backend, "avx2") == 0 && __builtin_cpu_supports("avx2")) {
+            mul_add = region_avx2<true>;
+            mul = region_avx2<false>;
+            name = "avx2";
+            return true;
+        }
+        if (std::strcmp(backend, "ssse3") == 0 && __builtin_cpu_supports("ssse3")) {
+            mul_add = region_ssse3<true>;
+            mul = region_ssse3<false>;
+            name = "ssse3";
+            return true;
+        }
+#endif
+        return false;
+    }
+};
+
+Gf256Kernels& kernels() {
+    static Gf256Kernels k;
+    return k;
+}
+
+} // namespace
+
+uint8_t gf256_mul(uint8_t a, uint8_t b) {
+    return tables().mul[a][b];
+}
+
+uint8_t gf256_inv(uint8_t a) {
+    const auto& t = tables();
+    return t.exp[255 - t.log[a]];
+}
+
+void gf256_mul_add_region(uint8_t c, const uint8_t* src, uint8_t* dst, size_t len) {
+    if (c == 0 || len == 0) return;
+    if (c == 1) {
+        for (size_t i = 0; i < len; ++i) dst[i] ^= src[i];
+        return;
+    }
+    kernels().mul_add(c, src, dst, len);
+}
+
+void gf256_mul_region(uint8_t c, const uint8_t* src, uint8_t* dst, size_t len) {
+    if (len == 0) return;
+    if (c == 0) {
+        std::memset(dst, 0, len);
+        return;
+    }
+    if (c == 1) {
+        if (dst != src) std::memmove(dst, src, len);
+        return;
+    }
+    kernels().mul(c, src, dst, len);
+}
+
+bool gf256_invert_matrix(const uint8_t* in, uint8_t* out, int n) {
+    // Gauss-Jordan on [A | I]
+    std::vector<uint8_t> a(in, in + n * n);
+    std::memset(out, 0, n * n);
+    for (int i = 0; i < n; ++i) out[i * n + i] = 1;
+
+    for (int col = 0; col < n; ++col) {
+        int pivot = col;
+        while (pivot < n && a[pivot * n + col] == 0) ++pivot;
+        if (pivot == n) return false;
+
+        if (pivot != col) {
+            for (int j = 0; j < n; ++j) {
+                std::swap(a[col * n + j], a[pivot * n + j]);
+                std::swap(out[col * n + j], out[pivot * n + j]);
+            }
+        }
+
+        uint8_t scale = gf256_inv(a[col * n + col]);
+        for (int j = 0; j < n; ++j) {
+            a[col * n + j] = gf256_mul(a[col * n + j], scale);
+            out[col * n + j] = gf256_mul(out[col * n + j], scale);
+        }
+
+        for (int row = 0; row < n; ++row) {
+            uint8_t f = a[row * n + col];
+            if (row == col || f == 0) continue;
+            for (int j = 0; j < n; ++j) {
+                a[row * n + j] ^= gf256_mul(f, a[col * n + j]);
+                out[row * n + j] ^= gf256_mul(f, out[col * n + j]);
+            }
+        }
+    }
+
+    return true;
+}
+
+const char* gf256_backend() {
+    return kernels().name;
+}
+
+bool gf256_select_backend(const char* name) {
+    return kernels().select(name);
+}
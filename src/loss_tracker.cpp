@@ -8,13 +8,22 @@ LossTracker::LossTracker(int timeout_ms) : timeout_ms_(timeout_ms) {}
 
 void LossTracker::ping_sent(int port) {
     std::lock_guard<std::mutex> lock(mutex_);
-    ping_map_[port].sent_time = steady_clock::now();
-    ping_map_[port].waiting_response = true;
+    auto& info = ping_map_[port];
+    info.sent_time = steady_clock::now();
+    info.waiting_response = true;
+
+    // One outstanding ping per port: a new ping replaces the previous deadline
+    ping_timeouts_.cancel(info.timer);
+    info.timer = ping_timeouts_.schedule(info.sent_time + milliseconds(timeout_ms_),
+                                         static_cast<uint32_t>(port));
 }
 
 void LossTracker::pong_received(int port) {
     std::lock_guard<std::mutex> lock(mutex_);
-    ping_map_[port].waiting_response = false;
+    auto& info = ping_map_[port];
+    info.waiting_response = false;
+    ping_timeouts_.cancel(info.timer);
+    info.timer = 0;
 }
 
 void LossTracker::packetSent(int port) {
@@ -24,6 +33,14 @@ void LossTracker::packetSent(int port) {
     stats.last_sent_time = steady_clock::now();
 }
 
+void LossTracker::packetsSent(int port, uint64_t count) {
+    if (count == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& stats = port_stats_[port];
+    stats.packets_sent += count;
+    stats.last_sent_time = steady_clock::now();
+}
+
 void LossTracker::packetReceived(int port) {
     std::lock_guard<std::mutex> lock(mutex_);
     auto& stats = port_stats_[port];
@@ -31,19 +48,26 @@ void LossTracker::packetReceived(int port) {
     stats.last_received_time = steady_clock::now();
 }
 
+void LossTracker::packetsReceived(int port, uint64_t count) {
+    if (count == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& stats = port_stats_[port];
+    // Reports lag the send side by one trip; never count more than was sent
+    stats.packets_received = std::min(stats.packets_received + count, stats.packets_sent);
+    stats.last_received_time = steady_clock::now();
+}
+
 void LossTracker::update() {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto now = steady_clock::now();
-
-    for (auto& [port, info] : ping_map_) {
-        if (info.waiting_response) {
-            auto elapsed = duration_cast<milliseconds>(now - info.sent_time).count();
-            if (elapsed > timeout_ms_) {
-                info.loss_count++;
-                info.waiting_response = false;  // Tek sayılır
-            }
-        }
-    }
+
+    // Only pings whose deadline passed are visited
+    ping_timeouts_.advance(steady_clock::now(), [this](uint64_t tag) {
+        auto it = ping_map_.find(static_cast<int>(static_cast<uint32_t>(tag)));
+        if (it == ping_map_.end() || !it->second.waiting_response) return;
+        it->second.loss_count++;
+        it->second.waiting_response = false;  // Tek sayılır
+        it->second.timer = 0;
+    });
 }
 
 int LossTracker::get_loss_count(int port) const {
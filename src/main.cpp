@@ -1,5 +1,6 @@
 #include "sender_receiver.hpp"
 #include <thread>
+#include <atomic>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -9,7 +10,8 @@
 #include <sys/shm.h>
 #include <sys/sem.h>
 
-static volatile bool should_exit = false;
+// Lock-free, so the handler may store to it
+static std::atomic<bool> should_exit{false};
 
 void signal_handler(int sig) {
     std::cout << "\nReceived signal " << sig << ", shutting down gracefully..." << std::endl;
@@ -17,10 +19,22 @@ void signal_handler(int sig) {
 }
 
 int main(int argc, char** argv) {
-    if (argc < 5) {
-        std::cerr << "Usage: " << argv[0] << " <my_ip> <my_port> <remote_ip> <remote_port>" << std::endl;
+    RunOptions options;
+    options.stop = &should_exit;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--headless") options.headless = true;
+        else if (arg == "--source" && i + 1 < argc) options.source = argv[++i];
+        else args.push_back(arg);
+    }
+
+    if (args.size() < 4) {
+        std::cerr << "Usage: " << argv[0] << " <my_ip> <my_port> <remote_ip> <remote_port> [--headless] [--source <spec>]" << std::endl;
         std::cerr << "Example: " << argv[0] << " 192.168.1.5 45000 192.168.1.10 45001" << std::endl;
         std::cerr << "Each side uses different ports for bidirectional communication" << std::endl;
+        std::cerr << "--headless: no preview or receiver window, stop with Ctrl+C" << std::endl;
+        std::cerr << "--source: camera[:N] (default), synthetic[:complexity 0..1], file.y4m or file.yuv (640x480 I420)" << std::endl;
         return 1;
     }
 
@@ -28,14 +42,16 @@ int main(int argc, char** argv) {
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
 
-    std::string my_ip = argv[1];
-    int my_port = std::stoi(argv[2]);
-    std::string remote_ip = argv[3];
-    int remote_port = std::stoi(argv[4]);
+    std::string my_ip = args[0];
+    int my_port = std::stoi(args[1]);
+    std::string remote_ip = args[2];
+    int remote_port = std::stoi(args[3]);
 
     std::cout << "Starting NovaEngine in bidirectional mode with fork..." << std::endl;
     std::cout << "My IP: " << my_ip << ":" << my_port << std::endl;
     std::cout << "Remote IP: " << remote_ip << ":" << remote_port << std::endl;
+    if (options.headless) std::cout << "Headless mode: no windows" << std::endl;
+    std::cout << "Frame source: " << options.source << std::endl;
 
     // Her taraf kendi portunu dinliyor, karşı tarafın portuna gönderiyor
     std::vector<int> my_ports = {my_port};
@@ -53,7 +69,7 @@ int main(int argc, char** argv) {
         signal(SIGTERM, signal_handler);
         
         try {
-            run_sender(remote_ip, remote_ports);
+            run_sender(remote_ip, remote_ports, options);
         } catch (const std::exception& e) {
             std::cerr << "[SENDER] Exception: " << e.what() << std::endl;
         }
@@ -66,7 +82,7 @@ int main(int argc, char** argv) {
         std::cout << "[RECEIVER] Sender PID: " << sender_pid << std::endl;
         
         try {
-            run_receiver(my_ports);
+            run_receiver(my_ports, options);
         } catch (const std::exception& e) {
             std::cerr << "[RECEIVER] Exception: " << e.what() << std::endl;
         }
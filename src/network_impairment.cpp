@@ -0,0 +1,205 @@
+#include "network_impairment.hpp"
+#include <sys/socket.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+using Clock = std::chrono::steady_clock;
+
+static int64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count();
+}
+
+static bool send_datagram(int fd, const sockaddr_in& to, const uint8_t* data, size_t len) {
+    return sendto(fd, data, len, MSG_DONTWAIT, reinterpret_cast<const sockaddr*>(&to), sizeof(to)) >= 0;
+}
+
+NetworkImpairment::NetworkImpairment(std::vector<ImpairmentConfig> paths, uint64_t seed, Sink sink)
+    : sink_(sink ? std::move(sink) : Sink(send_datagram)), seed_(seed) {
+    if (paths.empty())
+        throw std::runtime_error("NetworkImpairment needs at least one path configuration");
+    for (const ImpairmentConfig& config : paths) {
+        paths_.emplace_back();
+        paths_.back().config = config;
+        paths_.back().rng.seed(seed_ + paths_.size() - 1);
+    }
+    thread_ = std::thread(&NetworkImpairment::run, this);
+}
+
+NetworkImpairment::~NetworkImpairment() {
+    stop();
+}
+
+void NetworkImpairment::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wakeup_.notify_one();
+    if (thread_.joinable()) thread_.join();
+}
+
+// Paths past the configured ones copy the last configuration with their own RNG stream
+NetworkImpairment::PathState& NetworkImpairment::path_state(size_t path) {
+    while (paths_.size() <= path) {
+        ImpairmentConfig config = paths_.back().config;
+        paths_.emplace_back();
+        paths_.back().config = config;
+        paths_.back().rng.seed(seed_ + paths_.size() - 1);
+    }
+    return paths_[path];
+}
+
+// 53 random bits → [0, 1); unlike std::uniform_real_distribution this is the same on every
+// standard library, so a seed reproduces a run across machines
+double NetworkImpairment::uniform(PathState& state) {
+    return (state.rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+int64_t NetworkImpairment::delay_us(PathState& state) {
+    const ImpairmentConfig& c = state.config;
+    double delay_ms = c.delay_ms;
+    switch (c.distribution) {
+    case DelayDistribution::CONSTANT:
+        break;
+    case DelayDistribution::UNIFORM:
+        delay_ms += c.jitter_ms * (2.0 * uniform(state) - 1.0);
+        break;
+    case DelayDistribution::NORMAL: {
+        // Box–Muller, again for portability
+        double u1 = 1.0 - uniform(state);
+        double u2 = uniform(state);
+        delay_ms += c.jitter_ms * std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+        break;
+    }
+    case DelayDistribution::PARETO:
+        delay_ms += c.jitter_ms * (std::pow(1.0 - uniform(state), -1.0 / 2.5) - 1.0);
+        break;
+    }
+    return static_cast<int64_t>(std::max(delay_ms, 0.0) * 1000.0);
+}
+
+void NetworkImpairment::submit(size_t path, int fd, const sockaddr_in& to, const iovec* iov, int iov_count) {
+    size_t len = 0;
+    for (int i = 0; i < iov_count; ++i) len += iov[i].iov_len;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        PathState& state = path_state(path);
+        const ImpairmentConfig& c = state.config;
+        state.stats.submitted++;
+
+        // Gilbert–Elliott: state transition, then the loss draw of the new state
+        const double transition = uniform(state);
+        if (state.bad ? transition < c.bad_to_good : transition < c.good_to_bad) state.bad = !state.bad;
+        if (uniform(state) < (state.bad ? c.loss_bad : c.loss_good)) {
+            state.stats.lost++;
+            return;
+        }
+
+        const int64_t now = now_us();
+        int64_t depart = now;
+        if (c.rate_bps > 0) {
+            // Token bucket as the time the link frees up; credit is capped at burst_bytes
+            const int64_t burst_us = static_cast<int64_t>(c.burst_bytes) * 8 * 1000000 / c.rate_bps;
+            state.link_free_us = std::max(state.link_free_us, now - burst_us);
+            const int64_t backlog_bytes = std::max<int64_t>(state.link_free_us - now, 0) * c.rate_bps / 8 / 1000000;
+            if (static_cast<size_t>(backlog_bytes) + len > c.queue_limit_bytes) {
+                state.stats.queue_drops++;
+                return;
+            }
+            depart = std::max(state.link_free_us, now);
+            state.link_free_us += static_cast<int64_t>(len) * 8 * 1000000 / c.rate_bps;
+        }
+
+        int64_t release = depart + delay_us(state);
+        if (uniform(state) < c.reorder) {
+            // Held back; packets behind it overtake, the in-order floor is left alone
+            release += static_cast<int64_t>(c.reorder_gap_ms * 1000.0);
+            state.stats.reordered++;
+        } else {
+            release = std::max(release, state.last_release_us);
+            state.last_release_us = release;
+        }
+
+        schedule(path, release, fd, to, iov, iov_count);
+        if (uniform(state) < c.duplicate) {
+            schedule(path, release, fd, to, iov, iov_count);
+            state.stats.duplicated++;
+        }
+    }
+    wakeup_.notify_one();
+}
+
+// Caller holds the lock
+void NetworkImpairment::schedule(size_t path, int64_t release_us, int fd, const sockaddr_in& to,
+                                 const iovec* iov, int iov_count) {
+    std::vector<uint8_t> data;
+    if (!free_buffers_.empty()) {
+        data.swap(free_buffers_.back());
+        free_buffers_.pop_back();
+    }
+    data.clear();
+    for (int i = 0; i < iov_count; ++i) {
+        const uint8_t* base = static_cast<const uint8_t*>(iov[i].iov_base);
+        data.insert(data.end(), base, base + iov[i].iov_len);
+    }
+    pending_.push(Pending{release_us, next_order_++, path, fd, to, std::move(data)});
+}
+
+void NetworkImpairment::set_config(size_t path, const ImpairmentConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    path_state(path).config = config;
+}
+
+ImpairmentStats NetworkImpairment::stats(size_t path) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return path < paths_.size() ? paths_[path].stats : ImpairmentStats{};
+}
+
+size_t NetworkImpairment::path_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return paths_.size();
+}
+
+void NetworkImpairment::run() {
+    std::vector<Pending> due;
+    std::vector<bool> sent;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        if (pending_.empty()) {
+            wakeup_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+            continue;
+        }
+
+        const int64_t now = now_us();
+        const int64_t next = pending_.top().release_us;
+        if (next > now) {
+            // A new submit may release earlier; it notifies and the deadline is re-read
+            wakeup_.wait_until(lock, Clock::time_point(std::chrono::microseconds(next)));
+            continue;
+        }
+
+        due.clear();
+        while (!pending_.empty() && pending_.top().release_us <= now) {
+            due.push_back(std::move(const_cast<Pending&>(pending_.top())));
+            pending_.pop();
+        }
+
+        // The socket calls run without the lock so submit never waits on the kernel
+        lock.unlock();
+        sent.assign(due.size(), false);
+        for (size_t i = 0; i < due.size(); ++i)
+            sent[i] = sink_(due[i].fd, due[i].to, due[i].data.data(), due[i].data.size());
+        lock.lock();
+
+        for (size_t i = 0; i < due.size(); ++i) {
+            ImpairmentStats& stats = paths_[due[i].path].stats;
+            if (sent[i]) stats.delivered++;
+            else stats.send_errors++;
+            free_buffers_.push_back(std::move(due[i].data));
+        }
+    }
+}
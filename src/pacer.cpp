@@ -0,0 +1,178 @@
+#include "pacer.hpp"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+
+using Clock = std::chrono::steady_clock;
+
+static int64_t to_us(Clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count();
+}
+
+static size_t wire_bits(const PacketView& pkt) {
+    return (PACKET_HEADER_SIZE + pkt.payload_size) * 8;
+}
+
+Pacer::Pacer(UdpSender& sender, const std::string& target_ip, const std::vector<int>& ports,
+             std::chrono::milliseconds max_delay, bool kernel_pacing)
+    : sender_(sender), target_ip_(target_ip), ports_(ports), max_delay_us_(max_delay.count() * 1000) {
+    sent_.datagrams_per_path.assign(ports_.size(), 0);
+    if (kernel_pacing) {
+        use_txtime_ = sender_.enable_txtime();
+        std::cout << "[PACER] Kernel pacing (SO_TXTIME) "
+                  << (use_txtime_ ? "enabled" : "unavailable, pacing in user space") << std::endl;
+    }
+    thread_ = std::thread(&Pacer::run, this);
+}
+
+Pacer::~Pacer() {
+    stop();
+}
+
+void Pacer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wakeup_.notify_one();
+    if (thread_.joinable()) thread_.join();
+}
+
+void Pacer::set_rate(int bits_per_second) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rate_bps_ = std::max(bits_per_second, 1000);
+}
+
+void Pacer::set_max_delay(std::chrono::milliseconds max_delay) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_delay_us_ = std::max<int64_t>(max_delay.count() * 1000, 1000);
+}
+
+void Pacer::enqueue(const std::vector<PacketView>& packets, bool priority) {
+    if (packets.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        drain_deadline_us_ = to_us(Clock::now()) + max_delay_us_;
+        std::deque<PacketView>& queue = priority ? priority_ : queue_;
+        for (const PacketView& pkt : packets) {
+            queue.push_back(pkt);
+            queued_bytes_ += wire_bits(pkt) / 8;
+        }
+    }
+    wakeup_.notify_one();
+}
+
+size_t Pacer::drop_frame(uint32_t frame_id) {
+    auto of_frame = [frame_id](const PacketView& pkt) { return pkt.frame_id == frame_id; };
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    size_t dropped = 0;
+    for (std::deque<PacketView>* queue : {&priority_, &queue_}) {
+        for (const PacketView& pkt : *queue) {
+            if (of_frame(pkt)) queued_bytes_ -= wire_bits(pkt) / 8;
+        }
+        auto first_dropped = std::remove_if(queue->begin(), queue->end(), of_frame);
+        dropped += queue->end() - first_dropped;
+        queue->erase(first_dropped, queue->end());
+    }
+
+    // A batch already handed to the socket still reads the payloads
+    sent_cv_.wait(lock, [&] {
+        return !sending_ || std::none_of(in_flight_.begin(), in_flight_.end(), of_frame);
+    });
+    assert(std::none_of(priority_.begin(), priority_.end(), of_frame) &&
+           std::none_of(queue_.begin(), queue_.end(), of_frame) &&
+           "pacer still holds packets of a dropped frame");
+
+    dropped_ += dropped;
+    return dropped;
+}
+
+uint64_t Pacer::dropped() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+BatchSendResult Pacer::take_sent() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    BatchSendResult taken = sent_;
+    sent_.datagrams_per_path.assign(ports_.size(), 0);
+    sent_.datagrams_sent = 0;
+    sent_.bytes_sent = 0;
+    return taken;
+}
+
+size_t Pacer::queued() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return priority_.size() + queue_.size();
+}
+
+void Pacer::run() {
+    std::vector<PacketView>& batch = in_flight_;
+    std::vector<int64_t> departures;
+    batch.reserve(MAX_BATCH);
+    departures.reserve(MAX_BATCH);
+
+    // Token bucket kept as the departure time of the next packet: tokens are
+    // (now - next_departure) * rate, capped at BURST_US worth of credit
+    int64_t next_departure_us = 0;
+    const int64_t lookahead_us = use_txtime_ ? TXTIME_LOOKAHEAD_US : 0;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        if (priority_.empty() && queue_.empty()) {
+            wakeup_.wait(lock, [this] { return stop_ || !priority_.empty() || !queue_.empty(); });
+            continue;
+        }
+
+        const int64_t now_us = to_us(Clock::now());
+        next_departure_us = std::max(next_departure_us, now_us - BURST_US);
+
+        // Not enough tokens yet: sleep until the next packet may leave
+        if (next_departure_us > now_us + lookahead_us) {
+            wakeup_.wait_until(lock, Clock::time_point(std::chrono::microseconds(next_departure_us - lookahead_us)),
+                               [this] { return stop_; });
+            continue;
+        }
+
+        // A backlog that would outlast max_delay after the latest enqueue at the target
+        // rate drains faster instead
+        const int64_t time_left_us = std::max<int64_t>(drain_deadline_us_ - now_us, 1000);
+        const int64_t rate = std::max<int64_t>(rate_bps_,
+            static_cast<int64_t>(queued_bytes_) * 8 * 1000000 / time_left_us);
+
+        batch.clear();
+        departures.clear();
+        while (batch.size() < MAX_BATCH && next_departure_us <= now_us + lookahead_us) {
+            std::deque<PacketView>& queue = !priority_.empty() ? priority_ : queue_;
+            if (queue.empty()) break;
+
+            PacketView pkt = queue.front();
+            queue.pop_front();
+            const size_t bits = wire_bits(pkt);
+            queued_bytes_ -= bits / 8;
+
+            const int64_t departure_us = std::max(next_departure_us, now_us);
+            pkt.timestamp = departure_us;
+            batch.push_back(pkt);
+            departures.push_back(departure_us * 1000);
+            next_departure_us += static_cast<int64_t>(bits) * 1000000 / rate;
+        }
+
+        // The socket calls run without the lock so enqueue never waits on the kernel;
+        // drop_frame() waits on sent_cv_ while this batch is out
+        sending_ = true;
+        lock.unlock();
+        BatchSendResult result = sender_.send_batch(target_ip_, ports_, batch,
+                                                    use_txtime_ ? departures.data() : nullptr);
+        lock.lock();
+        sending_ = false;
+        batch.clear();
+        sent_cv_.notify_all();
+
+        for (size_t p = 0; p < ports_.size(); ++p)
+            sent_.datagrams_per_path[p] += result.datagrams_per_path[p];
+        sent_.datagrams_sent += result.datagrams_sent;
+        sent_.bytes_sent += result.bytes_sent;
+    }
+}
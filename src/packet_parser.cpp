@@ -3,54 +3,68 @@
 #include <stdexcept>
 #include <cstdint>
 #include <cstddef>
-// Paket formatı:
-// [0-1]   frame_id      (2 byte)
-// [2]     chunk_id      (1 byte)
-// [3]     total_chunks  (1 byte)
-// [4-11]  timestamp     (8 byte - int64_t)
-// [12...] payload       (kalan veri)
+#include <algorithm>
+// Paket formatı: bkz. packet_parser.hpp (v2, 24 byte sabit başlık + payload)
 
-std::vector<uint8_t> serialize_packet(const ChunkPacket& pkt) {
-    std::vector<uint8_t> buffer;
-    buffer.reserve(12 + pkt.payload.size());
-
-    // frame_id (2 byte - little endian)
-    buffer.push_back(pkt.frame_id & 0xFF);
-    buffer.push_back((pkt.frame_id >> 8) & 0xFF);
-
-    // chunk_id (1 byte)
-    buffer.push_back(pkt.chunk_id);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+static void swap_header(PacketHeader& hdr) {
+    hdr.group_index = __builtin_bswap16(hdr.group_index);
+    hdr.block_size = __builtin_bswap16(hdr.block_size);
+    hdr.frame_id = __builtin_bswap32(hdr.frame_id);
+    hdr.frame_length = __builtin_bswap32(hdr.frame_length);
+    hdr.timestamp = static_cast<int64_t>(__builtin_bswap64(static_cast<uint64_t>(hdr.timestamp)));
+}
+#else
+static void swap_header(PacketHeader&) {}
+#endif
 
-    // total_chunks (1 byte)
-    buffer.push_back(pkt.total_chunks);
+void write_packet_header(const PacketHeader& hdr, uint8_t* out) {
+    PacketHeader wire = hdr;
+    wire.version = PACKET_VERSION;
+    swap_header(wire);
+    std::memcpy(out, &wire, PACKET_HEADER_SIZE);
+}
 
-    // timestamp (8 byte - little endian)
-    for (int i = 0; i < 8; ++i) {
-        buffer.push_back((pkt.timestamp >> (i * 8)) & 0xFF);
-    }
+std::vector<uint8_t> serialize_packet(const ChunkPacket& pkt) {
+    std::vector<uint8_t> buffer(PACKET_HEADER_SIZE + pkt.payload.size());
+    write_packet_header(pkt, buffer.data());
 
     // payload
-    buffer.insert(buffer.end(), pkt.payload.begin(), pkt.payload.end());
+    std::copy(pkt.payload.begin(), pkt.payload.end(), buffer.begin() + PACKET_HEADER_SIZE);
 
     return buffer;
 }
 
+// Single fixed-size copy of the whole header; receive buffers are 8-byte aligned
+static bool read_packet_header(const uint8_t* data, size_t len, PacketHeader& hdr) {
+    if (len < PACKET_HEADER_SIZE) return false;
+
+    std::memcpy(&hdr, data, PACKET_HEADER_SIZE);
+    swap_header(hdr);
+
+    return hdr.version == PACKET_VERSION &&
+           hdr.k > 0 && hdr.block_index < hdr.k + hdr.r &&
+           hdr.block_size > 0 && len - PACKET_HEADER_SIZE == hdr.block_size;
+}
+
 ChunkPacket parse_packet(const uint8_t* data, size_t len) {
-    if (len < 12) {
+    if (len < PACKET_HEADER_SIZE) {
         throw std::runtime_error("[parse_packet] Paket çok kısa!");
     }
 
     ChunkPacket pkt;
-    pkt.frame_id = data[0] | (data[1] << 8);  // Little endian
-    pkt.chunk_id = data[2];
-    pkt.total_chunks = data[3];
-
-    // timestamp (8 byte - little endian)
-    pkt.timestamp = 0;
-    for (int i = 0; i < 8; ++i) {
-        pkt.timestamp |= static_cast<int64_t>(data[4 + i]) << (i * 8);
+    if (!read_packet_header(data, len, pkt)) {
+        throw std::runtime_error("[parse_packet] Geçersiz paket başlığı!");
     }
 
-    pkt.payload.assign(data + 12, data + len);
+    pkt.payload.assign(data + PACKET_HEADER_SIZE, data + len);
     return pkt;
 }
+
+bool parse_packet_view(const uint8_t* data, size_t len, PacketView& view) {
+    if (!read_packet_header(data, len, view)) return false;
+
+    view.payload = data + PACKET_HEADER_SIZE;
+    view.payload_size = len - PACKET_HEADER_SIZE;
+    return true;
+}
@@ -0,0 +1,49 @@
+#include "retransmit_ring.hpp"
+
+static_assert((RetransmitRing::FRAME_COUNT & (RetransmitRing::FRAME_COUNT - 1)) == 0,
+              "FRAME_COUNT must be a power of two");
+
+const uint8_t* RetransmitRing::Frame::block(uint32_t group, int index) const {
+    if (index >= k) return parity.data() + (static_cast<size_t>(group) * r + (index - k)) * block_size;
+
+    // Data blocks live in the encoder output until it runs out, then in the padded tail
+    size_t d = static_cast<size_t>(group) * k + index;
+    size_t full_blocks = encoded.size() / block_size;
+    return d < full_blocks ? encoded.data() + d * block_size
+                           : tail.data() + (d - full_blocks) * block_size;
+}
+
+RetransmitRing::RetransmitRing() : frames_(FRAME_COUNT) {}
+
+RetransmitRing::Frame& RetransmitRing::prepare(uint32_t frame_id) {
+    Frame& frame = frames_[frame_id & (FRAME_COUNT - 1)];
+    frame.valid = false;
+    frame.frame_id = frame_id;
+    return frame;
+}
+
+const RetransmitRing::Frame* RetransmitRing::occupant(uint32_t frame_id) const {
+    const Frame& frame = frames_[frame_id & (FRAME_COUNT - 1)];
+    return frame.valid && frame.frame_id != frame_id ? &frame : nullptr;
+}
+
+const RetransmitRing::Frame* RetransmitRing::find(uint32_t frame_id) const {
+    const Frame& frame = frames_[frame_id & (FRAME_COUNT - 1)];
+    return frame.valid && frame.frame_id == frame_id ? &frame : nullptr;
+}
+
+bool RetransmitRing::lookup(uint32_t frame_id, uint16_t group, uint8_t block_index, PacketView& out) const {
+    const Frame* frame = find(frame_id);
+    if (!frame || group >= frame->group_count || block_index >= frame->k + frame->r) return false;
+
+    out.k = frame->k;
+    out.r = frame->r;
+    out.block_index = block_index;
+    out.group_index = group;
+    out.block_size = frame->block_size;
+    out.frame_id = frame->frame_id;
+    out.frame_length = frame->frame_length;
+    out.payload = frame->block(group, block_index);
+    out.payload_size = frame->block_size;
+    return true;
+}
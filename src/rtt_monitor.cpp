@@ -26,13 +26,7 @@ void RTTMonitor::receive_pong(int port) {
         auto sent_time = it->second;
         auto now = steady_clock::now();
         auto rtt_ms = duration_cast<milliseconds>(now - sent_time).count();
-        rtt_map[port] = static_cast<double>(rtt_ms);
-        
-        // Update RTT history for averaging
-        rtt_history[port].push_back(static_cast<double>(rtt_ms));
-        if (rtt_history[port].size() > MAX_HISTORY_SIZE) {
-            rtt_history[port].pop_front();
-        }
+        add_sample(port, static_cast<double>(rtt_ms));
         
         // Opsiyonel: debug çıktısı
         std::cout << "[RTT] Port " << port << " RTT = " << rtt_ms << " ms\n";
@@ -46,20 +40,29 @@ void RTTMonitor::receivePong(int port, int64_t timestamp) {
     if (it != ping_timestamps.end()) {
         auto sent_timestamp = it->second;
         auto rtt_us = timestamp - sent_timestamp;
-        auto rtt_ms = rtt_us / 1000.0;
-        
-        rtt_map[port] = rtt_ms;
-        
-        // Update RTT history for averaging
-        rtt_history[port].push_back(rtt_ms);
-        if (rtt_history[port].size() > MAX_HISTORY_SIZE) {
-            rtt_history[port].pop_front();
-        }
+        add_sample(port, rtt_us / 1000.0);
         
         ping_timestamps.erase(port);
     }
 }
 
+void RTTMonitor::recordRTT(int port, double rtt_ms) {
+    if (rtt_ms < 0) return;
+    std::lock_guard<std::mutex> lock(monitor_mutex);
+    add_sample(port, rtt_ms);
+}
+
+void RTTMonitor::add_sample(int port, double rtt_ms) {
+    rtt_map[port] = rtt_ms;
+
+    // Update RTT history for averaging
+    auto& history = rtt_history[port];
+    history.push_back(rtt_ms);
+    if (history.size() > MAX_HISTORY_SIZE) {
+        history.pop_front();
+    }
+}
+
 double RTTMonitor::get_rtt(int port) {
     std::lock_guard<std::mutex> lock(monitor_mutex);
     auto it = rtt_map.find(port);
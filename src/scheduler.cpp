@@ -52,27 +52,13 @@ void WeightedScheduler::update_metrics(const std::vector<PathStats>& paths) {
     build_weight_table();
 }
 
-// ---------------------- Global interface ----------------------
+// ---------------------- Defaults ----------------------
 
-static WeightedScheduler* g_scheduler = nullptr;
-
-void init_scheduler(const std::vector<int>& ports) {
+std::vector<PathStats> default_path_stats(const std::string& ip, const std::vector<int>& ports) {
     std::vector<PathStats> stats;
-
     for (int port : ports) {
         // Şimdilik RTT 50ms ve loss 0.0 varsayalım. Daha sonra RTTMonitor ve LossTracker'dan güncellenecek.
-        stats.emplace_back("127.0.0.1", port, 50.0, 0.0);
+        stats.emplace_back(ip, port, 50.0, 0.0);
     }
-
-    if (g_scheduler) delete g_scheduler;
-    g_scheduler = new WeightedScheduler(stats);
-
-    std::cout << "[scheduler] Scheduler başlatıldı " << ports.size() << " port ile.\n";
-}
-
-int select_port_for_chunk(int chunk_id) {
-    if (!g_scheduler) throw std::runtime_error("Scheduler not initialized");
-
-    PathStats selected = g_scheduler->select_path();
-    return selected.port;
+    return stats;
 }
@@ -1,379 +1,346 @@
 #include "sender_receiver.hpp"
+#include "session.hpp"
 #include "ffmpeg_encoder.h"
-#include "slicer.hpp"
-#include "erasure_coder.hpp"
-#include "udp_sender.hpp"
-#include "packet_parser.hpp"
-#include "smart_collector.hpp"
 #include "decode_and_display.hpp"
-#include "rtt_monitor.hpp"
-#include "loss_tracker.hpp"
+#include "spsc_ring.hpp"
+#include "stage_counters.hpp"
+#include "triple_buffer.hpp"
+#include "frame_source.hpp"
 
 #include <opencv2/videoio.hpp>
 #include <opencv2/core.hpp>
 #include <opencv2/highgui.hpp>
+#include <opencv2/imgproc.hpp>
 
-#include <fcntl.h>
 #include <iostream>
 #include <thread>
+#include <atomic>
 #include <vector>
 #include <chrono>
-#include <deque>
-#include <algorithm>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <unistd.h>
+#include <memory>
+#include <stdexcept>
 
 using namespace std;
 using namespace cv;
 typedef chrono::steady_clock Clock;
 
-enum StatField { CAPTURE, ENCODE, SEND, DISPLAY, FIELD_COUNT };
-
-// Enhanced bitrate adaptation with network monitoring
-class AdaptiveBitrateController {
-private:
-    static constexpr int WINDOW_SIZE = 10; // 10-second window
-    static constexpr double TARGET_LATENCY_MS = 100.0;
-    static constexpr double MAX_PACKET_LOSS_RATE = 0.05; // 5%
-    
-    deque<pair<Clock::time_point, double>> throughput_history;
-    deque<pair<Clock::time_point, double>> rtt_history;
-    deque<pair<Clock::time_point, double>> loss_history;
-    
-    int current_bitrate;
-    int target_fps;
-    
-public:
-    AdaptiveBitrateController(int initial_bitrate, int fps) 
-        : current_bitrate(initial_bitrate), target_fps(fps) {}
-    
-    void updateMetrics(double throughput_kbps, double rtt_ms, double loss_rate) {
-        auto now = Clock::now();
-        
-        // Update throughput history
-        throughput_history.push_back({now, throughput_kbps});
-        if (throughput_history.size() > WINDOW_SIZE) {
-            throughput_history.pop_front();
-        }
-        
-        // Update RTT history
-        rtt_history.push_back({now, rtt_ms});
-        if (rtt_history.size() > WINDOW_SIZE) {
-            rtt_history.pop_front();
-        }
-        
-        // Update loss history
-        loss_history.push_back({now, loss_rate});
-        if (loss_history.size() > WINDOW_SIZE) {
-            loss_history.pop_front();
-        }
-    }
-    
-    int getOptimalBitrate() {
-        if (throughput_history.size() < 3) return current_bitrate;
-        
-        // Calculate moving averages
-        double avg_throughput = 0, avg_rtt = 0, avg_loss = 0;
-        for (const auto& [_, val] : throughput_history) avg_throughput += val;
-        for (const auto& [_, val] : rtt_history) avg_rtt += val;
-        for (const auto& [_, val] : loss_history) avg_loss += val;
-        
-        avg_throughput /= throughput_history.size();
-        avg_rtt /= rtt_history.size();
-        avg_loss /= loss_history.size();
-        
-        // Determine optimal bitrate based on network conditions
-        int optimal_bitrate = current_bitrate;
-        
-        // If network is congested (high RTT or loss), reduce bitrate
-        if (avg_rtt > TARGET_LATENCY_MS * 1.5 || avg_loss > MAX_PACKET_LOSS_RATE) {
-            if (current_bitrate > 1000000) optimal_bitrate = 1000000;      // 1 Mbps
-            else if (current_bitrate > 800000) optimal_bitrate = 800000;   // 800 kbps
-            else optimal_bitrate = 600000;                                 // 600 kbps
-        }
-        // If network is good and we have headroom, increase bitrate
-        else if (avg_rtt < TARGET_LATENCY_MS * 0.8 && avg_loss < MAX_PACKET_LOSS_RATE * 0.5) {
-            if (avg_throughput > current_bitrate * 1.5) {
-                if (current_bitrate < 1000000) optimal_bitrate = 1000000;      // 1 Mbps
-                else if (current_bitrate < 1800000) optimal_bitrate = 1800000; // 1.8 Mbps
-                else if (current_bitrate < 3000000) optimal_bitrate = 3000000; // 3 Mbps
-            }
-        }
-        
-        // Ensure we don't exceed available throughput
-        optimal_bitrate = min(optimal_bitrate, static_cast<int>(avg_throughput * 0.8));
-        
-        // Bitrate tiers: 600k, 1M, 1.8M, 3M
-        if (optimal_bitrate <= 800000) optimal_bitrate = 600000;
-        else if (optimal_bitrate <= 1400000) optimal_bitrate = 1000000;
-        else if (optimal_bitrate <= 2400000) optimal_bitrate = 1800000;
-        else optimal_bitrate = 3000000;
-        
-        return optimal_bitrate;
-    }
-    
-    int getOptimalFPS() {
-        // Adjust FPS based on bitrate to maintain quality
-        if (current_bitrate <= 1000000) return 20;
-        else if (current_bitrate <= 1800000) return 25;
-        else return 30;
-    }
-    
-    void setCurrentBitrate(int bitrate) { current_bitrate = bitrate; }
-    int getCurrentBitrate() const { return current_bitrate; }
+enum StatField { CAPTURE, ENCODE, DISPLAY, FIELD_COUNT };
+
+// Sender pipeline: capture → encode → SenderSession (FEC/send on the session's network thread).
+// Capture hands the encoder its newest frame through a triple buffer; encoded frames go to the
+// session through an SPSC ring of pooled buffers. Display is never part of it: an optional
+// consumer thread shows the newest frame from another triple buffer, and headless runs have no
+// HighGUI at all.
+constexpr size_t ENCODED_QUEUE_DEPTH = 4;
+// Idle stages poll their input ring; next to a frame period this wakeup latency is noise
+constexpr auto STAGE_IDLE = chrono::microseconds(500);
+
+struct CapturedFrame {
+    Mat image;
+    Clock::time_point captured;
 };
 
-void run_sender(const string& target_ip, const vector<int>& target_ports) {
+// Congestion control bounds; the encoder target follows the session's controller between them
+constexpr int MIN_BITRATE = 150000;
+constexpr int MAX_BITRATE = 4000000;
+
+// Hybrid ARQ: the receiver holds an incomplete frame this much longer for retransmissions,
+// the sender only resends when the measured RTT fits in what is left of it
+constexpr int RETRANSMIT_BUDGET_MS = 60;
+
+constexpr bool KERNEL_PACING = true;   // SO_TXTIME when the kernel supports it
+
+// Polling interval of the main thread while the pipeline threads do the work
+constexpr auto STOP_POLL = chrono::milliseconds(50);
+
+static bool stop_requested(const RunOptions& options) {
+    return options.stop && options.stop->load(memory_order_relaxed);
+}
+
+
+void run_sender(const string& target_ip, const vector<int>& target_ports, const RunOptions& options) {
     if (target_ports.empty()) {
         cerr << "Usage: sender <target_ip> <port1> [port2 ...]" << endl;
         exit(1);
     }
 
-    if (!init_udp_sockets(target_ports)) {
-        cerr << "[ERROR] UDP sockets could not be initialized." << endl;
+    int width = options.width, height = options.height, fps = options.fps, bitrate = options.bitrate;
+    shared_ptr<FrameSource> source = options.frame_source;
+    try {
+        if (!source) source = open_frame_source(options.source, width, height, fps);
+    } catch (const exception& e) {
+        cerr << "[ERROR] Frame source: " << e.what() << endl;
         exit(1);
     }
-
-    // Initialize target addresses for zero-copy optimization
-    set_target_addresses(target_ip, target_ports);
-
-    int width = 640, height = 480, fps = 30, bitrate = 600000;
-    VideoCapture cap(0, cv::CAP_V4L2);
-    cap.set(CAP_PROP_FRAME_WIDTH, width);
-    cap.set(CAP_PROP_FRAME_HEIGHT, height);
-    cap.set(CAP_PROP_FPS, fps);
-    if (!cap.isOpened()) {
-        cerr << "Camera could not be started." << endl;
+    cout << "[SENDER] Frame source: " << source->describe() << endl;
+    width = source->width();
+    height = source->height();
+    fps = source->fps();
+
+    // FEC, pacing, feedback and congestion control live in the transport session
+    SenderSessionConfig config;
+    config.remote_ip = target_ip;
+    config.remote_ports = target_ports;
+    config.local_ports = options.local_ports;
+    config.fec_k = options.fec_k;
+    config.fec_r = options.fec_r;
+    config.bitrate = bitrate;
+    config.min_bitrate = MIN_BITRATE;
+    config.max_bitrate = MAX_BITRATE;
+    config.adapt_bitrate = options.adapt_bitrate;
+    config.fps = fps;
+    config.kernel_pacing = KERNEL_PACING;
+    config.queue_depth = ENCODED_QUEUE_DEPTH;
+    config.impairment = options.impairment;
+    config.counters = options.counters;
+    unique_ptr<SenderSession> session;
+    try {
+        session = make_unique<SenderSession>(config);
+    } catch (const exception& e) {
+        cerr << "[ERROR] " << e.what() << endl;
         exit(1);
     }
 
+    // I420 sources (synthetic, files) go to the encoder as-is; only the display thread converts them
+    const bool source_i420 = source->format() == FrameFormat::I420;
     FFmpegEncoder encoder(width, height, fps, bitrate);
-    uint16_t frame_id = 0;
-    Mat frame;
-    ErasureCoder fec(8, 4); // k = 8, r = 4
-
-    // Enhanced network monitoring
-    RTTMonitor rtt_monitor;
-    LossTracker loss_tracker;
-    AdaptiveBitrateController bitrate_controller(bitrate, fps);
-
-    chrono::milliseconds frame_duration(1000 / fps);
-    double stats[FIELD_COUNT] = {0};
-    int frame_count = 0;
-    auto stats_start = Clock::now();
 
-    // Enhanced throughput measurement
-    size_t bytes_sent = 0;
-    size_t packets_sent = 0;
-    auto throughput_start = Clock::now();
-    
-    // Network metrics collection
-    auto metrics_start = Clock::now();
-
-    while (true) {
-        auto t0 = Clock::now();
-
-        auto tc0 = Clock::now();
-        cap.read(frame);
-        auto tc1 = Clock::now();
-        stats[CAPTURE] += chrono::duration<double, milli>(tc1 - tc0).count();
-
-        if (!frame.empty()) {
-            auto te0 = Clock::now();
-            vector<uint8_t> encoded;
-            encoder.encodeFrame(frame, encoded);
-            auto te1 = Clock::now();
-            stats[ENCODE] += chrono::duration<double, milli>(te1 - te0).count();
-
-            auto ts0 = Clock::now();
-            auto chunks = slice_frame(encoded, frame_id, 1000);
-
-            vector<vector<uint8_t>> k_blocks;
-            for (int i = 0; i < 8 && i < chunks.size(); ++i)
-                k_blocks.push_back(chunks[i].payload);
-
-            if (k_blocks.size() < 8) {
-                size_t block_size = k_blocks.empty() ? 0 : k_blocks[0].size();
-                k_blocks.resize(8, vector<uint8_t>(block_size, 0));
+    // Stage handoff. Encoded frames are never dropped (the H.264 reference chain needs them
+    // all), so backpressure lands on the captured frames: a newer capture replaces one the
+    // encoder has not picked up, and the encoder always gets the newest.
+    TripleBuffer<CapturedFrame> captured;
+    TripleBuffer<CapturedFrame> preview;
+    const bool show_preview = !options.headless;
+    StageCounters stages[FIELD_COUNT];
+    atomic<bool> running{true};
+
+    // Capture: paced to the session's target fps, never waits on the encoder
+    thread capture_thread([&]() {
+        auto next_capture = Clock::now();
+        while (running) {
+            auto t0 = Clock::now();
+            CapturedFrame& slot = captured.write_buffer();
+            Mat& image = slot.image;
+            bool have_frame = source->read(image);
+            auto t1 = Clock::now();
+
+            if (!have_frame) {
+                this_thread::sleep_for(chrono::milliseconds(5));
+                continue;
+            }
+            slot.captured = t0;
+            // A frame still waiting for the encoder is stale now: the newest one replaces it
+            if (captured.publish()) stages[CAPTURE].dropped.fetch_add(1, memory_order_relaxed);
+            stages[CAPTURE].record(t1 - t0, t1 - t0);
+
+            // The preview gets the raw frame; colour conversion is the display thread's job.
+            // Read-only source memory outlives the source's frames, so its header is shared;
+            // anything else is copied, because the capture slot is refilled while on screen.
+            if (show_preview) {
+                CapturedFrame& view = preview.write_buffer();
+                if (source->frames_writable()) image.copyTo(view.image);
+                else view.image = image;
+                view.captured = t0;
+                preview.publish();
             }
 
-            vector<vector<uint8_t>> all_blocks;
-            fec.encode(k_blocks, all_blocks);
-
-            // Enhanced multipath sending with weighted scheduling
-            for (int i = 0; i < all_blocks.size(); ++i) {
-                ChunkPacket pkt;
-                pkt.frame_id = frame_id;
-                pkt.chunk_id = i;
-                pkt.total_chunks = all_blocks.size();
-                pkt.payload = all_blocks[i];
-                pkt.timestamp = chrono::duration_cast<chrono::microseconds>(
-                    Clock::now().time_since_epoch()).count();
-
-                // Track packet sending for loss calculation
-                for (int p : target_ports) {
-                    loss_tracker.packetSent(p);
-                }
-
-                // Use enhanced multipath sending
-                ssize_t sent = send_udp_multipath(target_ip, target_ports, pkt);
-                if (sent > 0) {
-                    bytes_sent += sent;
-                    packets_sent++;
-                    
-                    // Track RTT for this path (using first port as representative)
-                    rtt_monitor.startPing(target_ports[0], pkt.timestamp);
-                }
+            auto interval = chrono::milliseconds(1000 / session->target_fps());
+            next_capture = max(next_capture + interval, Clock::now() - interval);
+            this_thread::sleep_until(next_capture);
+        }
+    });
+
+    // Encode: only the newest captured frame is worth encoding; capture has dropped older ones.
+    // A frame the session has no room for is held and offered again before the next encode.
+    thread encode_thread([&]() {
+        vector<uint8_t> bitstream;
+        Clock::time_point bitstream_captured;
+        bool pending = false;
+        while (running) {
+            if (pending && !session->send_frame(bitstream, bitstream_captured)) {
+                this_thread::sleep_for(STAGE_IDLE);
+                continue;
             }
+            pending = false;
 
-            // Enhanced bitrate adaptation every second
-            auto now_tp = Clock::now();
-            if (chrono::duration_cast<chrono::seconds>(now_tp - throughput_start).count() >= 1) {
-                double throughput_kbps = (bytes_sent * 8) / 1000.0;
-                double avg_rtt = rtt_monitor.getAverageRTT();
-                double loss_rate = loss_tracker.getLossRate();
-                
-                // Update bitrate controller
-                bitrate_controller.updateMetrics(throughput_kbps, avg_rtt, loss_rate);
-                int optimal_bitrate = bitrate_controller.getOptimalBitrate();
-                int optimal_fps = bitrate_controller.getOptimalFPS();
-                
-                // Apply bitrate change if needed
-                if (optimal_bitrate != encoder.getBitrate()) {
-                    cout << "[ADAPTIVE] Bitrate: " << encoder.getBitrate()/1000 
-                         << "k -> " << optimal_bitrate/1000 << "k, RTT: " 
-                         << avg_rtt << "ms, Loss: " << (loss_rate*100) << "%" << endl;
-                    encoder.setBitrate(optimal_bitrate);
-                    bitrate_controller.setCurrentBitrate(optimal_bitrate);
-                }
-                
-                // Apply FPS change if needed
-                if (optimal_fps != fps) {
-                    cout << "[ADAPTIVE] FPS: " << fps << " -> " << optimal_fps << endl;
-                    fps = optimal_fps;
-                    frame_duration = chrono::milliseconds(1000 / fps);
-                }
-                
-                bytes_sent = 0;
-                packets_sent = 0;
-                throughput_start = now_tp;
+            CapturedFrame* in = captured.read();
+            if (!in) {
+                this_thread::sleep_for(STAGE_IDLE);
+                continue;
             }
 
-            auto ts1 = Clock::now();
-            stats[SEND] += chrono::duration<double, milli>(ts1 - ts0).count();
-            frame_id++;
-        }
+            int target = session->target_bitrate();
+            if (target != encoder.getBitrate()) encoder.setBitrate(target);
 
-        auto td0 = Clock::now();
-        imshow("NovaEngine - Sender (You)", frame);
-        if (waitKey(1) >= 0) break;
-        auto td1 = Clock::now();
-        stats[DISPLAY] += chrono::duration<double, milli>(td1 - td0).count();
+            auto t0 = Clock::now();
+            bitstream.clear();
+            encoder.encodeFrame(in->image, bitstream);
+            bitstream_captured = in->captured;
+            auto t1 = Clock::now();
+            stages[ENCODE].record(t1 - t0, t1 - bitstream_captured);
 
-        frame_count++;
-        auto now = Clock::now();
-        if (chrono::duration_cast<chrono::seconds>(now - stats_start).count() >= 1) {
-            cout << "Avg times (ms): Capture=" << stats[CAPTURE]/frame_count
-                 << ", Encode=" << stats[ENCODE]/frame_count
-                 << ", Send=" << stats[SEND]/frame_count
-                 << ", Display=" << stats[DISPLAY]/frame_count 
-                 << ", RTT=" << rtt_monitor.getAverageRTT() << "ms"
-                 << ", Loss=" << (loss_tracker.getLossRate()*100) << "%" << endl;
-            memset(stats, 0, sizeof(stats));
-            frame_count = 0;
-            stats_start = now;
+            // The encoder may buffer a frame; the buffer is simply reused
+            if (!bitstream.empty()) pending = !session->send_frame(bitstream, bitstream_captured);
         }
+    });
 
-        auto t1 = Clock::now();
-        auto loop_ms = chrono::duration_cast<chrono::milliseconds>(t1 - t0);
-        if (loop_ms < frame_duration) {
-            this_thread::sleep_for(frame_duration - loop_ms);
-        }
+    auto stats_start = Clock::now();
+    auto log_stats = [&]() {
+        auto now = Clock::now();
+        if (now - stats_start < chrono::seconds(1)) return;
+        stats_start = now;
+
+        StageCounters::Snapshot c = stages[CAPTURE].take();
+        StageCounters::Snapshot e = stages[ENCODE].take();
+        StageCounters::Snapshot d = stages[DISPLAY].take();
+        SenderSession::Stats net = session->stats();
+        cout << "[PIPELINE] Capture " << c.frames << " fps (" << c.work_ms << "ms, dropped " << c.dropped << ")"
+             << " | Encode " << e.work_ms << "ms"
+             << ", latency " << e.latency_ms << "ms"
+             << " | FEC q=" << net.queued_frames << " " << net.send.work_ms << "ms, latency " << net.send.latency_ms << "ms"
+             << " | Pacer q=" << net.pacer_queued << ", dropped " << net.pacer_dropped;
+        if (show_preview) cout << " | Display " << d.frames << " fps, latency " << d.latency_ms << "ms";
+        cout << endl;
+        cout << "[NETWORK] RTT=" << net.rtt_ms << "ms"
+             << ", Loss=" << (net.loss_rate*100) << "%"
+             << ", FrameLoss=" << net.recent_frame_losses << "/64"
+             << ", Resent=" << net.blocks_resent << " (skipped " << net.resends_skipped << ")" << endl;
+    };
+
+    // Display consumes the newest preview at its own pace; capture never waits on it.
+    // All HighGUI calls stay on this one thread.
+    thread display_thread;
+    if (show_preview) {
+        display_thread = thread([&]() {
+            Mat bgr;
+            while (running) {
+                CapturedFrame* view = preview.read();
+                if (view) {
+                    auto td0 = Clock::now();
+                    if (source_i420) cvtColor(view->image, bgr, COLOR_YUV2BGR_I420);
+                    imshow("NovaEngine - Sender (You)", source_i420 ? bgr : view->image);
+                    auto td1 = Clock::now();
+                    stages[DISPLAY].record(td1 - td0, td1 - view->captured);
+                }
+                if (waitKey(view ? 1 : 5) >= 0) running = false;
+            }
+            destroyAllWindows();
+        });
     }
 
-    close_udp_sockets();
-    destroyAllWindows();
+    while (running && !stop_requested(options)) {
+        this_thread::sleep_for(STOP_POLL);
+        log_stats();
+    }
+    running = false;
+
+    capture_thread.join();
+    encode_thread.join();
+    if (display_thread.joinable()) display_thread.join();
+    session->stop();
 }
 
-void run_receiver(const vector<int>& ports) {
-    constexpr int MAX_BUFFER = 1500;
+void run_receiver(const vector<int>& ports, const RunOptions& options) {
+    constexpr size_t ASSEMBLED_QUEUE_DEPTH = 8;
     const int disp_width = 640;
     const int disp_height = 480;
 
-    vector<int> sockets;
-    for (int port : ports) {
-        int sock = socket(AF_INET, SOCK_DGRAM, 0);
-        sockaddr_in addr{};
-        addr.sin_family = AF_INET;
-        addr.sin_port = htons(port);
-        addr.sin_addr.s_addr = INADDR_ANY;
-        bind(sock, (sockaddr*)&addr, sizeof(addr));
-        fcntl(sock, F_SETFL, O_NONBLOCK);
-        sockets.push_back(sock);
-        cout << "Listening UDP " << port << endl;
-    }
-
     H264Decoder decoder;
     Mat reconstructed_frame;
-    bool has_received = false;
-
-    SmartFrameCollector collector([&](const vector<uint8_t>& data) {
-        if (decoder.decode(data, reconstructed_frame)) {
-            has_received = true;
-        }
-    }, 8, 4); // k = 8, r = 4
-
-    cout << "Receiver started..." << endl;
 
-    while (true) {
-        for (int sock : sockets) {
-            uint8_t buf[MAX_BUFFER];
-            ssize_t len = recv(sock, buf, sizeof(buf), 0);
-            if (len >= 12) { // Updated minimum size for timestamp
-                auto pkt = parse_packet(buf, len);
-                
-                // Calculate RTT if timestamp is present
-                if (pkt.timestamp > 0) {
-                    auto now_us = chrono::duration_cast<chrono::microseconds>(
-                        Clock::now().time_since_epoch()).count();
-                    auto rtt_us = now_us - pkt.timestamp;
-                    auto rtt_ms = rtt_us / 1000.0;
-                    
-                    // Log RTT occasionally
-                    static int rtt_log_counter = 0;
-                    if (++rtt_log_counter % 100 == 0) {
-                        cout << "[RTT] Frame " << pkt.frame_id << " RTT: " << rtt_ms << "ms" << endl;
-                    }
-                }
-                
-                collector.handle(pkt);
+    // Reassembled frames go from the session's receive thread to the decode loop through a
+    // lock-free SPSC ring; slot buffers keep their capacity, so the handoff does not allocate
+    SpscRing<vector<uint8_t>> assembled(ASSEMBLED_QUEUE_DEPTH);
+    uint64_t handoff_drops = 0;
+
+    ReceiverSessionConfig config;
+    config.local_ports = ports;
+    config.fec_k = options.fec_k;
+    config.fec_r = options.fec_r;
+    config.retransmit_budget_ms = RETRANSMIT_BUDGET_MS;
+    config.counters = options.counters;
+    unique_ptr<ReceiverSession> session;
+    try {
+        session = make_unique<ReceiverSession>(config, [&](const uint8_t* data, size_t size) {
+            vector<uint8_t>* slot = assembled.acquire();
+            if (!slot) {
+                // Decoder is behind: drop rather than stall packet ingestion
+                if (++handoff_drops % 30 == 1)
+                    cerr << "[COLLECTOR] Decode queue full, dropped " << handoff_drops << " frames" << endl;
+                return;
             }
-        }
+            slot->assign(data, data + size);
+            assembled.publish();
+        });
+    } catch (const exception& e) {
+        cerr << "[ERROR] " << e.what() << endl;
+        return;
+    }
 
-        collector.flush_expired_frames();
+    cout << "Receiver started..." << endl;
 
-        Mat display_frame;
-        if (has_received && !reconstructed_frame.empty()) {
-            Mat resized;
-            resize(reconstructed_frame, resized, Size(disp_width, disp_height));
-            display_frame = resized;
-        } else {
-            display_frame = Mat::zeros(disp_height, disp_width, CV_8UC3);
-            putText(display_frame,
+    // Display, when enabled, is a consumer of the newest decoded frame and owns all HighGUI calls;
+    // a slow window only skips frames, it never holds up decoding.
+    atomic<bool> running{true};
+    TripleBuffer<Mat> latest;
+    const bool show_frames = !options.headless;
+    thread display_thread;
+    if (show_frames) {
+        display_thread = thread([&]() {
+            Mat waiting = Mat::zeros(disp_height, disp_width, CV_8UC3);
+            putText(waiting,
                     "Waiting for Client to Connect..",
                     Point(20, disp_height/2),
                     FONT_HERSHEY_SIMPLEX,
                     1.0,
                     Scalar(255,255,255),
                     2);
-        }
+            imshow("NovaEngine - Receiver", waiting);
+
+            while (running) {
+                if (Mat* frame = latest.read()) imshow("NovaEngine - Receiver", *frame);
+                if (waitKey(5) == 27) running = false;
+            }
+            destroyAllWindows();
+        });
+    }
 
-        imshow("NovaEngine - Receiver", display_frame);
-        if (waitKey(1) == 27) break;
-        this_thread::sleep_for(chrono::milliseconds(1));
+    auto stats_start = Clock::now();
+    auto log_stats = [&]() {
+        auto now = Clock::now();
+        if (now - stats_start < chrono::seconds(1)) return;
+        stats_start = now;
+
+        ReceiverSession::Stats net = session->stats();
+        cout << "[COLLECTOR] Jitter " << net.jitter_ms << "ms, playout delay " << net.playout_delay_ms << "ms"
+             << " | Groups systematic " << net.groups_systematic << ", reconstructed " << net.groups_reconstructed
+             << " | Frames lost " << net.frames_lost << ", NACKs " << net.nacks_sent << endl;
+    };
+
+    // Decode runs at its own pace and never blocks packet ingestion.
+    // Every queued frame is decoded (the H.264 reference chain needs them all), the last one is published.
+    while (running && !stop_requested(options)) {
+        log_stats();
+        bool decoded = false;
+        while (vector<uint8_t>* frame = assembled.peek()) {
+            bool fresh = decoder.decode(frame->data(), frame->size(), reconstructed_frame);
+            assembled.release();
+            if (!fresh) continue;
+            decoded = true;
+            if (options.counters) options.counters->frames_decoded.fetch_add(1, memory_order_relaxed);
+            if (options.on_decoded) options.on_decoded(reconstructed_frame);
+        }
+        if (!decoded) {
+            this_thread::sleep_for(STAGE_IDLE);
+            continue;
+        }
+        if (show_frames && !reconstructed_frame.empty()) {
+            resize(reconstructed_frame, latest.write_buffer(), Size(disp_width, disp_height));
+            latest.publish();
+        }
     }
 
-    for (int sock : sockets) close(sock);
-    destroyAllWindows();
+    running = false;
+    session->stop();
+    if (display_thread.joinable()) display_thread.join();
 }
@@ -0,0 +1,581 @@
+#include "session.hpp"
+#include "udp_sender.hpp"
+#include "udp_receiver.hpp"
+#include "packet_parser.hpp"
+#include "slicer.hpp"
+#include "erasure_coder.hpp"
+#include "smart_collector.hpp"
+#include "spsc_ring.hpp"
+#include "feedback.hpp"
+#include "retransmit_ring.hpp"
+#include "congestion_controller.hpp"
+#include "pacer.hpp"
+#include "rtt_monitor.hpp"
+#include "loss_tracker.hpp"
+#include "network_impairment.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+typedef chrono::steady_clock Clock;
+
+// FEC shape: every group carries k data + r parity blocks of at most MAX_BLOCK_SIZE bytes.
+// The v2 header carries (k, r), the group index and the frame length, so the receiver
+// learns the shape from the wire; MAX_FEC_GROUPS only bounds the per-frame scratch.
+constexpr size_t MAX_BLOCK_SIZE = 1000;
+constexpr int MAX_FEC_GROUPS = 1024;
+
+// Receiver reports (received counts per path, frame losses, echoed timestamp) feed the
+// sender's loss and RTT estimates
+constexpr int REPORT_INTERVAL_MS = 100;
+
+constexpr double BITRATE_APPLY_STEP = 0.05;  // smaller moves are not worth an encoder update
+
+// The pacer runs a little above the FEC-expanded media rate so queues drain between frames
+constexpr double PACING_HEADROOM = 1.25;
+
+// Idle network thread: wait this long for feedback before looking at the frame queue again
+constexpr int FEEDBACK_POLL_MS = 1;
+constexpr auto NETWORK_IDLE = chrono::microseconds(500);
+
+constexpr int RECEIVE_TIMEOUT_MS = 10;  // Upper bound between expiry checks
+
+static int pacing_rate(int bitrate, int k, int r) {
+    return static_cast<int>(bitrate * PACING_HEADROOM * (k + r) / k);
+}
+
+// Lower rates spread their bits over fewer frames to keep quality up
+static int fps_for_bitrate(int bitrate) {
+    if (bitrate <= 1000000) return 20;
+    else if (bitrate <= 1800000) return 25;
+    else return 30;
+}
+
+// ---------------------- SenderSession ----------------------
+
+struct QueuedFrame {
+    vector<uint8_t> data;
+    Clock::time_point captured;
+};
+
+struct SenderSession::Impl {
+    explicit Impl(const SenderSessionConfig& config);
+    ~Impl() { stop(); }
+
+    void stop();
+    void run();
+    void send_frame(QueuedFrame& in);
+    void collect_sent();
+    void handle_report(const uint8_t* data, size_t len);
+    void handle_feedback(const uint8_t* data, size_t len);
+
+    const SenderSessionConfig config;
+    const int fec_k;
+    const int fec_r;
+    UdpSender udp;
+    ErasureCoder fec;
+    SpscRing<QueuedFrame> frames;
+    unique_ptr<Pacer> pacer;
+
+    // Controller decisions, read by the application's encoder and capture threads
+    atomic<int> target_bitrate;
+    atomic<int> target_fps;
+    int fps;
+
+    // Everything below is touched by the network thread only, unless atomic
+    uint32_t frame_id = 0;
+
+    // Per-frame FEC scratch, reused across frames. Encoded frames and their parity are
+    // kept in the retransmit ring, so NACKed blocks can be resent without re-encoding.
+    RetransmitRing retransmit;
+    vector<const uint8_t*> data_ptrs;
+    vector<uint8_t*> parity_ptrs;
+    vector<PacketView> packets;
+    vector<PacketView> resend_packets;
+    vector<NackEntry> nack_entries;
+    atomic<uint64_t> blocks_resent{0};
+    atomic<uint64_t> resends_skipped{0};
+
+    // Last cumulative received count reported for each remote port
+    ReceiverReport report;
+    vector<ReportPath> report_paths;
+    vector<ArrivalSample> report_arrivals;
+    vector<uint32_t> reported_received;
+    atomic<int> recent_frame_losses{0};
+
+    RTTMonitor rtt_monitor;
+    LossTracker loss_tracker;
+    unique_ptr<CongestionController> congestion;
+
+    // Everything that left, resends included: the denominator of per-report loss
+    uint64_t datagrams_sent_total = 0;
+    uint64_t bytes_sent_total = 0;
+    uint64_t datagrams_sent_at_report = 0;
+    Clock::time_point last_report_time;
+    bool have_report = false;
+
+    StageCounters send_stage;
+    atomic<bool> running{true};
+    thread network_thread;
+};
+
+SenderSession::Impl::Impl(const SenderSessionConfig& cfg)
+    : config(cfg), fec_k(cfg.fec_k), fec_r(cfg.fec_r), fec(cfg.fec_k, cfg.fec_r),
+      frames(max<size_t>(cfg.queue_depth, 1)), target_bitrate(cfg.bitrate), target_fps(cfg.fps), fps(cfg.fps),
+      reported_received(cfg.remote_ports.size(), 0) {
+    if (config.remote_ports.empty())
+        throw runtime_error("SenderSession needs at least one remote port");
+    if (fps <= 0)
+        throw runtime_error("SenderSession needs a positive frame rate");
+
+    if (!udp.open(config.local_ports.empty() ? config.remote_ports : config.local_ports))
+        throw runtime_error("UDP sockets could not be initialized");
+
+    // Pre-compute target addresses for zero-copy sends
+    udp.set_targets(config.remote_ip, config.remote_ports);
+    if (config.impairment) udp.set_impairment(config.impairment);
+
+    congestion = make_unique<DelayGradientController>(config.bitrate, config.min_bitrate, config.max_bitrate);
+
+    // Packets leave on the pacer's thread, spread over at most one frame interval
+    pacer = make_unique<Pacer>(udp, config.remote_ip, config.remote_ports,
+                               chrono::milliseconds(1000 / fps), config.kernel_pacing);
+    pacer->set_rate(pacing_rate(config.bitrate, fec_k, fec_r));
+
+    network_thread = thread(&Impl::run, this);
+}
+
+void SenderSession::Impl::stop() {
+    running = false;
+    if (network_thread.joinable()) network_thread.join();
+    if (pacer) pacer->stop();
+    udp.close();
+}
+
+// Send accounting comes back from the pacer thread
+void SenderSession::Impl::collect_sent() {
+    BatchSendResult sent = pacer->take_sent();
+    for (size_t p = 0; p < config.remote_ports.size(); ++p) {
+        loss_tracker.packetsSent(config.remote_ports[p], sent.datagrams_per_path[p]);
+    }
+    datagrams_sent_total += sent.datagrams_sent;
+    bytes_sent_total += sent.bytes_sent;
+    if (config.counters) {
+        config.counters->datagrams_sent.fetch_add(sent.datagrams_sent, memory_order_relaxed);
+        config.counters->bytes_sent.fetch_add(sent.bytes_sent, memory_order_relaxed);
+    }
+}
+
+void SenderSession::Impl::handle_report(const uint8_t* data, size_t len) {
+    if (!parse_receiver_report(data, len, report, report_paths, report_arrivals)) return;
+    auto now = Clock::now();
+    collect_sent();
+
+    // Counts are cumulative, so a lost report costs nothing; a reordered one shows up
+    // as a negative step and is ignored
+    const vector<int>& ports = config.remote_ports;
+    uint64_t received = 0;
+    for (const ReportPath& path : report_paths) {
+        auto it = find(ports.begin(), ports.end(), path.port);
+        if (it == ports.end()) continue;
+        uint32_t& last = reported_received[it - ports.begin()];
+        uint32_t delta = path.received - last;
+        if (delta >= 0x80000000u) continue;
+        last = path.received;
+        loss_tracker.packetsReceived(path.port, delta);
+        received += delta;
+    }
+
+    // The echoed timestamp is ours, so no clock sync is needed; the receiver's hold
+    // time between the packet and the report is taken out
+    if (report.echo_timestamp_us > 0) {
+        auto now_us = chrono::duration_cast<chrono::microseconds>(now.time_since_epoch()).count();
+        int64_t rtt_us = now_us - report.echo_timestamp_us - static_cast<int64_t>(report.hold_us);
+        if (rtt_us >= 0) rtt_monitor.recordRTT(report.echo_port, rtt_us / 1000.0);
+    }
+
+    recent_frame_losses.store(__builtin_popcountll(report.frame_loss_mask), memory_order_relaxed);
+
+    // One controller step per report: delay gradient from the arrival samples, loss
+    // and delivered rate over the interval since the previous report
+    CongestionFeedback feedback;
+    feedback.now_ms = chrono::duration_cast<chrono::milliseconds>(now.time_since_epoch()).count();
+    feedback.arrivals = report_arrivals.data();
+    feedback.arrival_count = report_arrivals.size();
+    feedback.rtt_ms = rtt_monitor.getAverageRTT();
+    uint64_t interval_sent = datagrams_sent_total - datagrams_sent_at_report;
+    if (have_report && interval_sent > 0) {
+        feedback.loss_fraction = max(0.0, 1.0 - static_cast<double>(received) / interval_sent);
+        double interval_s = chrono::duration<double>(now - last_report_time).count();
+        double mean_datagram_bits = 8.0 * bytes_sent_total / datagrams_sent_total;
+        if (interval_s > 0) feedback.received_bps = received * mean_datagram_bits / interval_s;
+    }
+    datagrams_sent_at_report = datagrams_sent_total;
+    last_report_time = now;
+    have_report = true;
+    if (!config.adapt_bitrate) return;
+
+    congestion->on_feedback(feedback);
+    int target = congestion->target_bitrate();
+    int current = target_bitrate.load(memory_order_relaxed);
+    if (abs(target - current) >= current * BITRATE_APPLY_STEP) {
+        cout << "[ADAPTIVE] Bitrate: " << current/1000
+             << "k -> " << target/1000 << "k, RTT: " << feedback.rtt_ms
+             << "ms, Loss: " << (max(feedback.loss_fraction, 0.0)*100) << "%" << endl;
+        target_bitrate.store(target, memory_order_relaxed);
+        pacer->set_rate(pacing_rate(target, fec_k, fec_r));
+
+        int new_fps = fps_for_bitrate(target);
+        if (new_fps != fps) {
+            cout << "[ADAPTIVE] FPS: " << fps << " -> " << new_fps << endl;
+            fps = new_fps;
+            target_fps.store(fps, memory_order_relaxed);
+            pacer->set_max_delay(chrono::milliseconds(1000 / fps));
+        }
+    }
+}
+
+// Receiver feedback arrives on the bound sockets; NACKed blocks are resent from the ring
+void SenderSession::Impl::handle_feedback(const uint8_t* data, size_t len) {
+    uint8_t type = feedback_type(data, len);
+    if (type == FEEDBACK_REPORT) {
+        handle_report(data, len);
+        return;
+    }
+    if (type != FEEDBACK_NACK || !parse_nack(data, len, nack_entries)) return;
+
+    double rtt_ms = rtt_monitor.getAverageRTT();
+    resend_packets.clear();
+    for (const NackEntry& entry : nack_entries) {
+        // A resend that lands after the receiver's playout deadline is wasted bandwidth.
+        // Until an RTT has been measured, resends are assumed to make it.
+        if (rtt_ms > 0 && rtt_ms >= entry.budget_ms) {
+            resends_skipped.fetch_add(__builtin_popcountll(entry.missing_mask), memory_order_relaxed);
+            continue;
+        }
+        for (uint64_t mask = entry.missing_mask; mask; mask &= mask - 1) {
+            PacketView pkt;
+            if (!retransmit.lookup(entry.frame_id, entry.group_index, __builtin_ctzll(mask), pkt)) break;
+            resend_packets.push_back(pkt);
+        }
+    }
+    if (resend_packets.empty()) return;
+
+    // Resends jump the pacer queue: their playout deadline is closer than any new frame's
+    pacer->enqueue(resend_packets, true);
+    blocks_resent.fetch_add(resend_packets.size(), memory_order_relaxed);
+}
+
+void SenderSession::Impl::send_frame(QueuedFrame& in) {
+    auto ts0 = Clock::now();
+
+    // Split the frame into as many (k, r) groups as needed
+    FecLayout layout = plan_fec_groups(in.data.size(), fec_k, fec_r, MAX_BLOCK_SIZE, MAX_FEC_GROUPS);
+    const size_t block_size = layout.block_size;
+    const size_t data_blocks = static_cast<size_t>(layout.group_count) * fec_k;
+    const size_t parity_blocks = static_cast<size_t>(layout.group_count) * fec_r;
+
+    // The frame moves into the retransmit ring (swap, no copy) and the ring's old buffer
+    // goes back to the queue slot; full data blocks are read straight from it, only the
+    // blocks past the end are zero-padded. A slow pacer may still hold packets of the frame
+    // that owned the slot a full ring ago: they are dropped before its buffers are reused.
+    if (const RetransmitRing::Frame* evicted = retransmit.occupant(frame_id)) {
+        const uint32_t evicted_id = evicted->frame_id;
+        if (size_t dropped = pacer->drop_frame(evicted_id)) {
+            cerr << "[PACER] Dropped " << dropped << " unsent packets of frame " << evicted_id
+                 << " (backlog longer than the retransmit ring)" << endl;
+        }
+    }
+    RetransmitRing::Frame& kept = retransmit.prepare(frame_id);
+    kept.encoded.swap(in.data);
+    const Clock::time_point captured_at = in.captured;
+    frames.release();
+
+    const size_t frame_size = kept.encoded.size();
+    const size_t full_blocks = frame_size / block_size;
+    kept.tail.assign((data_blocks - full_blocks) * block_size, 0);
+    copy(kept.encoded.begin() + full_blocks * block_size, kept.encoded.end(), kept.tail.begin());
+    kept.parity.resize(parity_blocks * block_size);
+
+    data_ptrs.resize(data_blocks);
+    parity_ptrs.resize(parity_blocks);
+    for (size_t d = 0; d < data_blocks; ++d) {
+        data_ptrs[d] = d < full_blocks ? kept.encoded.data() + d * block_size
+                                       : kept.tail.data() + (d - full_blocks) * block_size;
+    }
+    for (size_t p = 0; p < parity_blocks; ++p) {
+        parity_ptrs[p] = kept.parity.data() + p * block_size;
+    }
+
+    for (int g = 0; g < layout.group_count; ++g) {
+        fec.encode(&data_ptrs[g * fec_k], &parity_ptrs[g * fec_r], block_size);
+    }
+
+    kept.k = fec_k;
+    kept.r = fec_r;
+    kept.block_size = block_size;
+    kept.frame_length = frame_size;
+    kept.group_count = layout.group_count;
+    kept.sent_time = Clock::now();
+    kept.valid = true;
+
+    // Interleave groups on the wire (block index major, group minor) so a loss
+    // burst is spread across groups instead of wiping out one of them
+    const int group_size = fec_k + fec_r;
+    packets.clear();
+    for (int idx = 0; idx < group_size; ++idx) {
+        for (int g = 0; g < layout.group_count; ++g) {
+            PacketView pkt;
+            pkt.k = fec_k;
+            pkt.r = fec_r;
+            pkt.block_index = idx;
+            pkt.group_index = g;
+            pkt.block_size = block_size;
+            pkt.frame_id = frame_id;
+            pkt.frame_length = frame_size;
+            pkt.payload = idx < fec_k ? data_ptrs[g * fec_k + idx]
+                                      : parity_ptrs[g * fec_r + (idx - fec_k)];
+            pkt.payload_size = block_size;
+            packets.push_back(pkt);
+        }
+    }
+
+    // The pacer stamps each packet as it leaves; only datagrams that actually
+    // left are counted, per path
+    pacer->enqueue(packets);
+    collect_sent();
+    frame_id++;
+    if (config.counters) config.counters->frames_sent.fetch_add(1, memory_order_relaxed);
+
+    auto ts1 = Clock::now();
+    send_stage.record(ts1 - ts0, ts1 - captured_at);
+}
+
+// FEC and send; also owns the feedback sockets and the congestion controller
+void SenderSession::Impl::run() {
+    auto on_feedback = [this](const uint8_t* data, size_t len, int) { handle_feedback(data, len); };
+    while (running) {
+        QueuedFrame* in = frames.peek();
+        if (!in) {
+            // Nothing to send: serve receiver feedback while waiting
+            if (udp.poll_feedback(FEEDBACK_POLL_MS, on_feedback) < 0) this_thread::sleep_for(NETWORK_IDLE);
+            continue;
+        }
+        send_frame(*in);
+        udp.poll_feedback(0, on_feedback);
+    }
+}
+
+SenderSession::SenderSession(const SenderSessionConfig& config) : impl_(make_unique<Impl>(config)) {}
+
+SenderSession::~SenderSession() = default;
+
+void SenderSession::stop() {
+    impl_->stop();
+}
+
+bool SenderSession::send_frame(vector<uint8_t>& frame, Clock::time_point captured) {
+    QueuedFrame* slot = impl_->frames.acquire();
+    if (!slot) return false;
+    slot->data.swap(frame);
+    slot->captured = captured;
+    impl_->frames.publish();
+    frame.clear();
+    return true;
+}
+
+bool SenderSession::send_frame(const uint8_t* data, size_t size, Clock::time_point captured) {
+    QueuedFrame* slot = impl_->frames.acquire();
+    if (!slot) return false;
+    slot->data.assign(data, data + size);
+    slot->captured = captured;
+    impl_->frames.publish();
+    return true;
+}
+
+int SenderSession::target_bitrate() const {
+    return impl_->target_bitrate.load(memory_order_relaxed);
+}
+
+int SenderSession::target_fps() const {
+    return impl_->target_fps.load(memory_order_relaxed);
+}
+
+SenderSession::Stats SenderSession::stats() {
+    Stats s;
+    s.queued_frames = impl_->frames.size();
+    s.pacer_queued = impl_->pacer->queued();
+    s.pacer_dropped = impl_->pacer->dropped();
+    s.rtt_ms = impl_->rtt_monitor.getAverageRTT();
+    s.loss_rate = impl_->loss_tracker.getLossRate();
+    s.recent_frame_losses = impl_->recent_frame_losses.load(memory_order_relaxed);
+    s.blocks_resent = impl_->blocks_resent.load(memory_order_relaxed);
+    s.resends_skipped = impl_->resends_skipped.load(memory_order_relaxed);
+    s.send = impl_->send_stage.take();
+    return s;
+}
+
+// ---------------------- ReceiverSession ----------------------
+
+struct ReceiverSession::Impl {
+    Impl(const ReceiverSessionConfig& config, FrameCallback on_frame);
+    ~Impl() { stop(); }
+
+    void stop();
+    void run();
+    void on_datagram(const uint8_t* data, size_t len, int port, const sockaddr_in& from);
+    void flush_nacks();
+    void send_report();
+
+    const ReceiverSessionConfig config;
+    FrameCallback on_frame;
+    UdpReceiver receiver;
+    SmartFrameCollector collector;
+
+    // NACKs are gathered while the collector runs and sent back to the media source
+    // from the socket the media arrived on, one datagram per MAX_NACK_ENTRIES
+    vector<NackEntry> pending_nacks;
+    sockaddr_in media_source{};
+    int media_port = -1;
+    alignas(8) uint8_t nack_buffer[NACK_HEADER_SIZE + MAX_NACK_ENTRIES * sizeof(NackEntry)];
+
+    // Receiver report state, touched only by the receive thread
+    vector<ReportPath> path_counts;
+    ReceiverReport report;
+    ArrivalGroups arrivals;
+    ArrivalSample arrival_samples[MAX_REPORT_ARRIVALS];
+    Clock::time_point echo_received;
+    Clock::time_point next_report;
+    alignas(8) uint8_t report_buffer[REPORT_HEADER_SIZE + sizeof(ReceiverReport) +
+                                     MAX_REPORT_PATHS * sizeof(ReportPath) +
+                                     MAX_REPORT_ARRIVALS * sizeof(ArrivalSample)];
+    // Collector state the stats() readers may not touch, published once per receive round
+    atomic<double> jitter_ms{0.0};
+    atomic<int> playout_delay_ms{0};
+
+    atomic<bool> running{true};
+    thread receive_thread;
+};
+
+ReceiverSession::Impl::Impl(const ReceiverSessionConfig& cfg, FrameCallback callback)
+    : config(cfg), on_frame(move(callback)),
+      collector([this](const uint8_t* data, size_t size) {
+          if (config.counters) config.counters->frames_reassembled.fetch_add(1, memory_order_relaxed);
+          if (on_frame) on_frame(data, size);
+      }, cfg.fec_k, cfg.fec_r),
+      path_counts(min(cfg.local_ports.size(), MAX_REPORT_PATHS)), next_report(Clock::now()) {
+    if (config.local_ports.empty())
+        throw runtime_error("ReceiverSession needs at least one local port");
+    if (!receiver.open(config.local_ports))
+        throw runtime_error("Receiver sockets could not be initialized");
+
+    for (size_t i = 0; i < path_counts.size(); ++i)
+        path_counts[i].port = static_cast<uint16_t>(config.local_ports[i]);
+
+    // Hybrid ARQ: an incomplete frame is held this much longer for retransmissions
+    if (config.retransmit_budget_ms > 0) {
+        collector.enable_nack([this](const NackEntry& entry) { pending_nacks.push_back(entry); },
+                              config.retransmit_budget_ms);
+    }
+
+    receive_thread = thread(&Impl::run, this);
+}
+
+void ReceiverSession::Impl::stop() {
+    running = false;
+    if (receive_thread.joinable()) receive_thread.join();
+    receiver.close();
+}
+
+void ReceiverSession::Impl::flush_nacks() {
+    if (pending_nacks.empty()) return;
+    if (media_port >= 0) {
+        for (size_t i = 0; i < pending_nacks.size(); i += MAX_NACK_ENTRIES) {
+            size_t count = min(MAX_NACK_ENTRIES, pending_nacks.size() - i);
+            size_t len = write_nack(&pending_nacks[i], count, nack_buffer);
+            receiver.send_to(media_port, media_source, nack_buffer, len);
+        }
+    }
+    pending_nacks.clear();
+}
+
+void ReceiverSession::Impl::send_report() {
+    auto now = Clock::now();
+    if (media_port < 0 || now < next_report) return;
+    next_report = now + chrono::milliseconds(REPORT_INTERVAL_MS);
+
+    collector.fill_report(report);
+    report.hold_us = report.echo_timestamp_us > 0
+        ? static_cast<uint32_t>(chrono::duration_cast<chrono::microseconds>(now - echo_received).count())
+        : 0;
+    size_t arrival_count = arrivals.take(arrival_samples, MAX_REPORT_ARRIVALS);
+    size_t len = write_receiver_report(report, path_counts.data(), path_counts.size(),
+                                       arrival_samples, arrival_count, report_buffer);
+    receiver.send_to(media_port, media_source, report_buffer, len);
+}
+
+void ReceiverSession::Impl::on_datagram(const uint8_t* data, size_t len, int port, const sockaddr_in& from) {
+    PacketView pkt;
+    if (!parse_packet_view(data, len, pkt)) return;
+    media_source = from;
+    media_port = port;
+    for (ReportPath& path : path_counts) {
+        if (path.port == port) {
+            path.received++;
+            break;
+        }
+    }
+    if (pkt.timestamp > 0) {
+        report.echo_timestamp_us = pkt.timestamp;
+        report.echo_port = static_cast<uint16_t>(port);
+        echo_received = Clock::now();
+        arrivals.on_packet(pkt.timestamp, chrono::duration_cast<chrono::microseconds>(
+            echo_received.time_since_epoch()).count());
+    }
+
+    // Payload is copied once, straight from the recvmmsg buffer into the frame
+    collector.handle(pkt);
+}
+
+// Event-driven receive loop: epoll wakeup, recvmmsg batches straight into the collector
+void ReceiverSession::Impl::run() {
+    auto handler = [this](const uint8_t* data, size_t len, int port, const sockaddr_in& from) {
+        on_datagram(data, len, port, from);
+    };
+    while (running) {
+        // Wake up for the next frame deadline; the collector is only ever touched here
+        int n = receiver.poll(collector.poll_timeout_ms(RECEIVE_TIMEOUT_MS), handler);
+        if (n < 0) break;
+        if (config.counters) config.counters->datagrams_received.fetch_add(n, memory_order_relaxed);
+
+        collector.flush_expired_frames();
+        flush_nacks();
+        send_report();
+        jitter_ms.store(collector.jitter_ms(), memory_order_relaxed);
+        playout_delay_ms.store(collector.playout_delay_ms(), memory_order_relaxed);
+    }
+}
+
+ReceiverSession::ReceiverSession(const ReceiverSessionConfig& config, FrameCallback on_frame)
+    : impl_(make_unique<Impl>(config, move(on_frame))) {}
+
+ReceiverSession::~ReceiverSession() = default;
+
+void ReceiverSession::stop() {
+    impl_->stop();
+}
+
+ReceiverSession::Stats ReceiverSession::stats() const {
+    Stats s;
+    s.jitter_ms = impl_->jitter_ms.load(memory_order_relaxed);
+    s.playout_delay_ms = impl_->playout_delay_ms.load(memory_order_relaxed);
+    s.groups_systematic = impl_->collector.systematic_hits();
+    s.groups_reconstructed = impl_->collector.reconstructions();
+    s.frames_lost = impl_->collector.frames_lost();
+    s.nacks_sent = impl_->collector.nacks_sent();
+    return s;
+}
@@ -26,3 +26,22 @@ std::vector<Chunk> slice_frame(const std::vector<uint8_t>& frame_data,
     return chunks;
 }
 
+
+FecLayout plan_fec_groups(size_t frame_size, int k, int r,
+                          size_t max_block_size, int max_groups) {
+    FecLayout layout{k, r, 1, 1};
+    if (frame_size == 0 || k <= 0 || max_block_size == 0) return layout;
+
+    size_t group_bytes = static_cast<size_t>(k) * max_block_size;
+    size_t groups = (frame_size + group_bytes - 1) / group_bytes;
+    groups = std::max<size_t>(1, std::min<size_t>(groups, static_cast<size_t>(std::max(1, max_groups))));
+
+    size_t data_blocks = groups * k;
+    layout.block_size = (frame_size + data_blocks - 1) / data_blocks;
+
+    // Rounding the block size up can leave a trailing group empty; the receiver
+    // derives the group count from (frame_length, k, block_size), so use the same formula
+    group_bytes = static_cast<size_t>(k) * layout.block_size;
+    layout.group_count = static_cast<int>((frame_size + group_bytes - 1) / group_bytes);
+    return layout;
+}
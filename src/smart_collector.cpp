@@ -4,138 +4,512 @@
 #include <thread>
 #include <algorithm>
 #include <deque>
+#include <cstring>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
 
 using Clock = std::chrono::steady_clock;
 using TimePoint = std::chrono::time_point<Clock>;
-constexpr int JITTER_TIMEOUT_MS = 50;  // Increased from 15ms to 50ms for better tolerance
 constexpr int MAX_FRAME_AGE_MS = 200;  // Maximum age before dropping frame
-constexpr int FLUSH_INTERVAL_MS = 10;  // More frequent flushing
+constexpr int RELEASE_AGE_MARGIN_MS = 10;  // A held frame is played out this long before it is too old
+constexpr size_t SLOT_RESERVE_BYTES = 128 * 1024;  // Typical frame matrix, grown on demand and kept
+constexpr int SHAPE_LOG_INTERVAL_MS = 1000;  // At most one unsupported-shape line per interval
+
+// RFC 1982 style comparison so frame ids keep ordering across the 32-bit wrap
+static bool frame_id_newer(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) > 0;
+}
 
 SmartFrameCollector::SmartFrameCollector(FrameReadyCallback cb, int k, int r)
-    : callback(std::move(cb)), fec(k, r), k_(k), r_(r) {
-    timeout_ms_ = JITTER_TIMEOUT_MS;
-    flush_thread = std::thread([this]() {
-        while (!stop_flag) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(FLUSH_INTERVAL_MS));
-            flush_expired_frames();
-        }
-    });
+    : callback(std::move(cb)), slots_(SLOT_COUNT),
+      on_deadline_([this](uint64_t tag) { on_deadline(tag); }) {
+    static_assert((SLOT_COUNT & (SLOT_COUNT - 1)) == 0, "SLOT_COUNT must be a power of two");
+    for (auto& slot : slots_) {
+        slot.blocks.reserve(SLOT_RESERVE_BYTES);
+        slot.group_masks.reserve(MAX_GROUPS);
+    }
+    coder_for(k, r); // The expected shape is ready before the first packet
 }
 
-SmartFrameCollector::~SmartFrameCollector() {
-    stop_flag = true;
-    if (flush_thread.joinable()) flush_thread.join();
+// Single-writer contract: the first thread to touch the collector owns it
+void SmartFrameCollector::check_owner() const {
+#ifndef NDEBUG
+    if (owner_ == std::thread::id()) owner_ = std::this_thread::get_id();
+    assert(owner_ == std::this_thread::get_id() && "SmartFrameCollector used from two threads");
+#endif
 }
 
 void SmartFrameCollector::handle(ChunkPacket pkt) {
-    if (pkt.total_chunks == 0 || pkt.chunk_id >= pkt.total_chunks)
+    PacketView view;
+    static_cast<PacketHeader&>(view) = pkt;
+    view.payload = pkt.payload.data();
+    view.payload_size = pkt.payload.size();
+    handle(view);
+}
+
+void SmartFrameCollector::handle(const PacketView& pkt) {
+    check_owner();
+    const int group_size = pkt.k + pkt.r;
+    const uint32_t group_count = pkt.group_count();
+    if (group_size > ErasureCoder::MAX_BLOCKS || pkt.block_index >= group_size ||
+        pkt.payload_size != pkt.block_size ||
+        pkt.frame_length == 0 || pkt.frame_length > MAX_FRAME_LENGTH ||
+        group_count > MAX_GROUPS || pkt.group_index >= group_count)
+        return;
+    // Checked before slot_for(), so an oversized shape cannot evict the frame in its slot
+    if (static_cast<size_t>(group_count) * group_size * pkt.block_size > MAX_SLOT_BYTES)
         return;
 
-    auto& frame = frame_buffer[pkt.frame_id];
+    update_jitter(pkt.timestamp);
 
-    // Initialize frame structure if first time
-    if (frame.chunks.empty()) {
-        frame.chunks.resize(pkt.total_chunks);
-        frame.received_flags.resize(pkt.total_chunks, false);
-        frame.total_chunks = pkt.total_chunks;
-        frame.arrival_time = Clock::now();
-    }
+    PartialFrame* slot = slot_for(pkt);
+    if (!slot) return;
+    PartialFrame& frame = *slot;
 
-    // Duplicate check
-    if (frame.received_flags[pkt.chunk_id])
+    // Duplicate or mismatched check
+    if (pkt.k != frame.k || pkt.r != frame.r || pkt.block_size != frame.block_size ||
+        pkt.frame_length != frame.frame_length)
         return;
 
-    frame.chunks[pkt.chunk_id] = std::move(pkt.payload);
-    frame.received_flags[pkt.chunk_id] = true;
+    int group = pkt.group_index;
+    int index = pkt.block_index;
+    uint64_t bit = uint64_t(1) << index;
+    // Duplicates, and any block of a group that is already recovered, stop here
+    if (frame.group_masks[group] & bit)
+        return;
+
+    std::memcpy(block_ptr(frame, group, index), pkt.payload, pkt.payload_size);
+    frame.group_masks[group] |= bit;
     frame.received_chunks++;
     frame.last_update = Clock::now();
 
-    // Try to decode immediately if we have enough chunks
-    if (frame.received_chunks >= static_cast<size_t>(k_)) {
-        std::vector<uint8_t> recovered;
-        if (fec.decode(frame.chunks, frame.received_flags, recovered)) {
-            // Check frame age before delivering
-            auto now = Clock::now();
-            auto frame_age = std::chrono::duration_cast<std::chrono::milliseconds>(
-                now - frame.arrival_time).count();
-            
-            if (frame_age < MAX_FRAME_AGE_MS) {
-                callback(recovered);
-            } else {
-                std::cerr << "[COLLECTOR] Dropping old frame " << pkt.frame_id 
-                         << " (age: " << frame_age << "ms)" << std::endl;
-            }
-            frame_buffer.erase(pkt.frame_id);
+    // Systematic code: with every data block present the group is already the payload,
+    // so no GF math runs. Parity is only touched when a data block is actually missing.
+    const uint64_t data_mask = (uint64_t(1) << frame.k) - 1;
+    const uint64_t mask = frame.group_masks[group];
+    bool recovered = false;
+    if ((mask & data_mask) == data_mask) {
+        systematic_hits_.fetch_add(1, std::memory_order_relaxed);
+        recovered = true;
+    } else if (__builtin_popcountll(mask) >= frame.k && decode_group(frame, group)) {
+        reconstructions_.fetch_add(1, std::memory_order_relaxed);
+        recovered = true;
+    }
+
+    if (recovered) {
+        // Saturate the mask so late parity never gets copied into a finished group
+        frame.group_masks[group] = ~uint64_t(0);
+        frame.groups_ready++;
+    }
+
+    // Once every group is recovered the frame waits for its turn in frame_id order
+    if (frame.groups_ready == static_cast<int>(frame.group_count)) {
+        frame.state = SlotState::READY;
+        deadlines_.cancel(frame.playout_timer);
+        deadlines_.cancel(frame.nack_timer);
+        frame.playout_timer = frame.nack_timer = 0;
+        // Played out one playout delay after its first packet, so network jitter is absorbed
+        // here rather than on screen; with a quiet path there is nothing to absorb
+        frame.release_at = jitter_ms() < PLAYOUT_FAST_PATH_JITTER_MS
+                               ? Clock::now()
+                               : frame.arrival_time + std::chrono::milliseconds(std::min(
+                                     playout_delay_ms(), MAX_FRAME_AGE_MS - RELEASE_AGE_MARGIN_MS));
+        frame.release_armed = false;
+        release_ready();
+
+        // Still queued behind a missing frame: wait at most one playout delay for it
+        if (frame.state == SlotState::READY && !frame.release_armed) {
+            frame.playout_timer = deadlines_.schedule(
+                Clock::now() + std::chrono::milliseconds(playout_delay_ms()),
+                (static_cast<uint64_t>(frame.frame_id) << 2) | DEADLINE_HOLD);
         }
     }
 }
 
-void SmartFrameCollector::flush_expired_frames() {
-    TimePoint now = Clock::now();
-    std::vector<uint16_t> to_finalize;
-    std::vector<uint16_t> to_drop;
-
-    for (auto& [fid, frame] : frame_buffer) {
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now - frame.last_update).count();
-        auto frame_age = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now - frame.arrival_time).count();
-        
-        // Drop frames that are too old
-        if (frame_age > MAX_FRAME_AGE_MS) {
-            to_drop.push_back(fid);
-            continue;
-        }
-        
-        // Try to finalize frames that have enough chunks and have timed out
-        if (frame.received_chunks >= static_cast<size_t>(k_) && elapsed > timeout_ms_) {
-            to_finalize.push_back(fid);
-        }
+void SmartFrameCollector::update_jitter(int64_t sender_timestamp_us) {
+    if (sender_timestamp_us <= 0) return;
+
+    // Relative transit: sender and receiver clocks differ by a constant that cancels out in D
+    int64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now().time_since_epoch()).count();
+    int64_t transit = now_us - sender_timestamp_us;
+
+    if (have_transit_) {
+        double d = static_cast<double>(std::llabs(transit - last_transit_us_));
+        jitter_us_ += (d - jitter_us_) / 16.0;
+    }
+    last_transit_us_ = transit;
+    have_transit_ = true;
+}
+
+int SmartFrameCollector::playout_delay_ms() const {
+    int delay = PLAYOUT_BASE_MS + static_cast<int>(std::ceil(4.0 * jitter_us_ / 1000.0));
+    delay = std::clamp(delay, MIN_PLAYOUT_MS, MAX_PLAYOUT_MS);
+    // Retransmissions need their own slack on top of the jitter allowance
+    return std::min(delay + retransmit_budget_ms_, MAX_FRAME_AGE_MS);
+}
+
+void SmartFrameCollector::enable_nack(NackHandler handler, int retransmit_budget_ms) {
+    nack_handler_ = std::move(handler);
+    retransmit_budget_ms_ = std::max(0, retransmit_budget_ms);
+}
+
+int SmartFrameCollector::nack_delay_ms() const {
+    int delay = NACK_MIN_DELAY_MS + static_cast<int>(std::ceil(2.0 * jitter_us_ / 1000.0));
+    return std::clamp(delay, NACK_MIN_DELAY_MS, NACK_MAX_DELAY_MS);
+}
+
+bool SmartFrameCollector::deliver(PartialFrame& frame) {
+    // Check frame age before delivering
+    auto frame_age = std::chrono::duration_cast<std::chrono::milliseconds>(
+        Clock::now() - frame.arrival_time).count();
+
+    const bool fresh = frame_age < MAX_FRAME_AGE_MS;
+    if (fresh) {
+        // Data region trimmed to the original length: padding never reaches the decoder
+        callback(frame.blocks.data(), frame.frame_length);
+    } else {
+        std::cerr << "[COLLECTOR] Dropping old frame " << frame.frame_id
+                 << " (age: " << frame_age << "ms)" << std::endl;
     }
+    finish(frame);
+    return fresh;
+}
 
-    // Drop old frames
-    for (uint16_t fid : to_drop) {
-        std::cerr << "[COLLECTOR] Dropping expired frame " << fid << std::endl;
-        frame_buffer.erase(fid);
-    }
-
-    // Try to decode frames that have timed out
-    for (uint16_t fid : to_finalize) {
-        auto& frame = frame_buffer[fid];
-        std::vector<uint8_t> recovered;
-        
-        if (fec.decode(frame.chunks, frame.received_flags, recovered)) {
-            auto frame_age = std::chrono::duration_cast<std::chrono::milliseconds>(
-                now - frame.arrival_time).count();
-            
-            if (frame_age < MAX_FRAME_AGE_MS) {
-                callback(recovered);
-            } else {
-                std::cerr << "[COLLECTOR] Dropping old frame " << fid 
-                         << " (age: " << frame_age << "ms)" << std::endl;
+void SmartFrameCollector::record_playout(uint32_t count, bool lost) {
+    if (count == 0) return;
+    if (lost) frames_lost_.fetch_add(count, std::memory_order_relaxed);
+
+    const uint64_t bits = count >= 64 ? ~uint64_t(0) : (uint64_t(1) << count) - 1;
+    playout_loss_mask_ = count >= 64 ? 0 : playout_loss_mask_ << count;
+    if (lost) playout_loss_mask_ |= bits;
+}
+
+void SmartFrameCollector::fill_report(ReceiverReport& report) const {
+    check_owner();
+    report.highest_frame_id = newest_frame_id_;
+    report.played_frame_id = next_release_ - 1;
+    report.frame_loss_mask = have_release_ ? playout_loss_mask_ : 0;
+}
+
+void SmartFrameCollector::release_ready() {
+    if (!have_release_) return;
+
+    for (;;) {
+        PartialFrame& frame = slots_[next_release_ & (SLOT_COUNT - 1)];
+        if (frame.state == SlotState::EMPTY || frame.frame_id != next_release_) return;  // not seen yet
+        if (frame.state == SlotState::ASSEMBLING) return;
+        if (frame.state == SlotState::READY && Clock::now() < frame.release_at) {
+            // Its turn, not its time yet: whatever timer it held gives way to the release time
+            if (!frame.release_armed) {
+                deadlines_.cancel(frame.playout_timer);
+                frame.playout_timer = deadlines_.schedule(
+                    frame.release_at, (static_cast<uint64_t>(frame.frame_id) << 2) | DEADLINE_PLAYOUT);
+                frame.release_armed = true;
             }
+            return;
+        }
+        // DONE at the playout point means the frame was given up on before its turn
+        bool delivered = frame.state == SlotState::READY && deliver(frame);
+        record_playout(1, !delivered);
+        next_release_++;
+    }
+}
+
+void SmartFrameCollector::skip_to(uint32_t frame_id) {
+    if (!frame_id_newer(frame_id, next_release_)) return;
+
+    // Only the last SLOT_COUNT ids can still occupy a slot
+    uint32_t first = frame_id - next_release_ > SLOT_COUNT ? frame_id - SLOT_COUNT : next_release_;
+    for (uint32_t id = first; id != frame_id; ++id) {
+        PartialFrame& frame = slots_[id & (SLOT_COUNT - 1)];
+        if (frame.frame_id == id && (frame.state == SlotState::ASSEMBLING || frame.state == SlotState::READY))
+            abandon(frame, "late");
+    }
+    // Everything skipped over, seen or not, never played
+    record_playout(frame_id - next_release_, true);
+    next_release_ = frame_id;
+}
+
+SmartFrameCollector::PartialFrame* SmartFrameCollector::slot_for(const PacketView& pkt) {
+    // Anything a full ring behind the newest frame has already been evicted
+    if (have_newest_) {
+        if (frame_id_newer(pkt.frame_id, newest_frame_id_)) {
+            newest_frame_id_ = pkt.frame_id;
+            stale_run_ = 0;
+        } else if (newest_frame_id_ - pkt.frame_id >= SLOT_COUNT) {
+            // A straggler now and then is normal; a steady stream of them means the sender
+            // restarted its frame ids, and they would not catch up for a long time
+            if (++stale_run_ < RESTART_STALE_PACKETS) return nullptr;
+            reset_sequence(pkt.frame_id);
         } else {
-            std::cerr << "[COLLECTOR] FEC decode failed for frame " << fid 
-                     << " (received: " << frame.received_chunks << "/" << frame.total_chunks << ")" << std::endl;
+            stale_run_ = 0;
         }
-        
-        frame_buffer.erase(fid);
-    }
-    
-    // Clean up very old frames to prevent memory leaks
-    if (frame_buffer.size() > 100) {
-        std::vector<std::pair<uint16_t, TimePoint>> frame_ages;
-        for (const auto& [fid, frame] : frame_buffer) {
-            frame_ages.emplace_back(fid, frame.arrival_time);
+    }
+    if (!have_newest_) {
+        newest_frame_id_ = pkt.frame_id;
+        have_newest_ = true;
+    }
+
+    // Frames behind the playout point were already released or skipped
+    if (have_release_) {
+        if (frame_id_newer(next_release_, pkt.frame_id)) return nullptr;
+        // Playout cannot lag the ring: older frames are about to lose their slots
+        if (newest_frame_id_ - next_release_ >= SLOT_COUNT)
+            skip_to(newest_frame_id_ - SLOT_COUNT + 1);
+    } else {
+        next_release_ = pkt.frame_id;
+        have_release_ = true;
+    }
+
+    PartialFrame& frame = slots_[pkt.frame_id & (SLOT_COUNT - 1)];
+    if (frame.state != SlotState::EMPTY && frame.frame_id == pkt.frame_id)
+        return frame.state == SlotState::ASSEMBLING ? &frame : nullptr;
+
+    // The slot belongs to an older frame: that frame is a full ring behind and can go
+    if (frame.state != SlotState::EMPTY && !frame_id_newer(pkt.frame_id, frame.frame_id))
+        return nullptr;
+    if (frame.state == SlotState::ASSEMBLING || frame.state == SlotState::READY)
+        abandon(frame, "evicted");
+
+    // Initialize the slot: the header carries the whole FEC shape
+    frame.fec = coder_for(pkt.k, pkt.r);
+    if (!frame.fec) return nullptr;
+
+    const uint32_t group_count = pkt.group_count();
+    frame.state = SlotState::ASSEMBLING;
+    frame.frame_id = pkt.frame_id;
+    frame.k = pkt.k;
+    frame.r = pkt.r;
+    frame.block_size = pkt.block_size;
+    frame.frame_length = pkt.frame_length;
+    frame.group_count = group_count;
+    frame.groups_ready = 0;
+    frame.received_chunks = 0;
+    // Every block is either received or rebuilt before delivery, so stale bytes are harmless
+    frame.blocks.resize(static_cast<size_t>(group_count) * (pkt.k + pkt.r) * frame.block_size);
+    frame.group_masks.assign(group_count, 0);
+    frame.arrival_time = Clock::now();
+    frame.last_update = frame.arrival_time;
+
+    // Both deadlines are set at the first packet; the playout timer re-arms itself lazily
+    // from last_update when it fires, so packets never touch the wheel
+    const uint64_t tag = static_cast<uint64_t>(frame.frame_id) << 2;
+    frame.age_timer = deadlines_.schedule(frame.arrival_time + std::chrono::milliseconds(MAX_FRAME_AGE_MS),
+                                          tag | DEADLINE_AGE);
+    frame.playout_timer = deadlines_.schedule(frame.arrival_time + std::chrono::milliseconds(playout_delay_ms()),
+                                              tag | DEADLINE_PLAYOUT);
+    frame.nack_rounds = 0;
+    frame.nack_timer = 0;
+    if (nack_handler_) {
+        frame.nack_timer = deadlines_.schedule(frame.arrival_time + std::chrono::milliseconds(nack_delay_ms()),
+                                               tag | DEADLINE_NACK);
+    }
+    return &frame;
+}
+
+void SmartFrameCollector::reset_sequence(uint32_t frame_id) {
+    std::cerr << "[COLLECTOR] Frame id went back from " << newest_frame_id_ << " to " << frame_id
+              << ", sender restarted; resetting" << std::endl;
+    for (auto& frame : slots_) {
+        if (frame.state == SlotState::ASSEMBLING || frame.state == SlotState::READY) finish(frame);
+        frame.state = SlotState::EMPTY;
+    }
+    have_newest_ = false;
+    have_release_ = false;
+    stale_run_ = 0;
+    // The new sender's clock has its own offset
+    have_transit_ = false;
+}
+
+void SmartFrameCollector::abandon(PartialFrame& frame, const char* reason) {
+    if (frame.state == SlotState::READY) {
+        std::cerr << "[COLLECTOR] Dropping decoded frame " << frame.frame_id << " (" << reason << ")" << std::endl;
+        finish(frame);
+        return;
+    }
+    std::cerr << "[COLLECTOR] FEC decode failed for frame " << frame.frame_id << " (" << reason
+             << ", groups: " << frame.groups_ready << "/" << frame.group_count
+             << ", received: " << frame.received_chunks << "/" << frame.group_count * (frame.k + frame.r) << ")" << std::endl;
+    finish(frame);
+}
+
+void SmartFrameCollector::finish(PartialFrame& frame) {
+    frame.state = SlotState::DONE;
+    deadlines_.cancel(frame.age_timer);
+    deadlines_.cancel(frame.playout_timer);
+    deadlines_.cancel(frame.nack_timer);
+    frame.age_timer = frame.playout_timer = frame.nack_timer = 0;
+}
+
+void SmartFrameCollector::on_deadline(uint64_t tag) {
+    const uint32_t frame_id = static_cast<uint32_t>(tag >> 2);
+    const uint64_t kind = tag & 3;
+    PartialFrame& frame = slots_[frame_id & (SLOT_COUNT - 1)];
+    if (frame.frame_id != frame_id ||
+        (frame.state != SlotState::ASSEMBLING && frame.state != SlotState::READY))
+        return;
+
+    if (kind == DEADLINE_AGE) {
+        frame.age_timer = 0;
+        abandon(frame, "too old");
+        return;
+    }
+
+    if (kind == DEADLINE_NACK) {
+        on_nack_deadline(frame, tag);
+        return;
+    }
+
+    frame.playout_timer = 0;
+    // A decoded frame reached its release time; flush_expired_frames() plays it out
+    if (kind == DEADLINE_PLAYOUT && frame.state == SlotState::READY) return;
+
+    if (kind == DEADLINE_HOLD) {
+        // The frames ahead of this one did not make it in time. Holds that expire on the
+        // same tick fire in any order, so play out from the oldest ready frame, not this one.
+        uint32_t resume = frame_id;
+        for (uint32_t id = next_release_; id != frame_id; ++id) {
+            const PartialFrame& ahead = slots_[id & (SLOT_COUNT - 1)];
+            if (ahead.frame_id == id && ahead.state == SlotState::READY) {
+                resume = id;
+                break;
+            }
         }
-        
-        std::sort(frame_ages.begin(), frame_ages.end(), 
-                 [](const auto& a, const auto& b) { return a.second < b.second; });
-        
-        // Keep only the 50 most recent frames
-        for (size_t i = 50; i < frame_ages.size(); ++i) {
-            frame_buffer.erase(frame_ages[i].first);
+        skip_to(resume);
+        return;
+    }
+
+    // Frames that stalled with some group short of k blocks cannot be recovered;
+    // a frame that is still receiving gets its playout deadline pushed out
+    auto playout_deadline = frame.last_update + std::chrono::milliseconds(playout_delay_ms());
+    if (Clock::now() < playout_deadline)
+        frame.playout_timer = deadlines_.schedule(playout_deadline, tag);
+    else
+        abandon(frame, "stalled");
+}
+
+void SmartFrameCollector::on_nack_deadline(PartialFrame& frame, uint64_t tag) {
+    frame.nack_timer = 0;
+    if (frame.state != SlotState::ASSEMBLING) return;
+
+    // Blocks may only be reordered: wait until the frame has been quiet for a NACK delay
+    auto now = Clock::now();
+    auto quiet_at = frame.last_update + std::chrono::milliseconds(nack_delay_ms());
+    if (now < quiet_at) {
+        frame.nack_timer = deadlines_.schedule(quiet_at, tag);
+        return;
+    }
+
+    send_nacks(frame);
+
+    // One more round if the retransmissions get lost too
+    if (++frame.nack_rounds < MAX_NACK_ROUNDS) {
+        int retry_ms = std::max(nack_delay_ms(), retransmit_budget_ms_ / 2);
+        frame.nack_timer = deadlines_.schedule(now + std::chrono::milliseconds(retry_ms), tag);
+    }
+}
+
+void SmartFrameCollector::send_nacks(PartialFrame& frame) {
+    auto now = Clock::now();
+    auto playout_left = frame.last_update + std::chrono::milliseconds(playout_delay_ms()) - now;
+    auto age_left = frame.arrival_time + std::chrono::milliseconds(MAX_FRAME_AGE_MS) - now;
+    auto budget = std::chrono::duration_cast<std::chrono::milliseconds>(std::min(playout_left, age_left)).count();
+    if (budget <= 0) return;
+
+    for (uint32_t g = 0; g < frame.group_count; ++g) {
+        const uint64_t mask = frame.group_masks[g];
+        if (mask == ~uint64_t(0)) continue;  // recovered
+
+        // Ask for just enough blocks to reach k, data blocks first so the group
+        // can still complete on the systematic path
+        int needed = frame.k - __builtin_popcountll(mask);
+        uint64_t request = 0;
+        for (int i = 0; i < frame.k + frame.r && needed > 0; ++i) {
+            uint64_t bit = uint64_t(1) << i;
+            if (mask & bit) continue;
+            request |= bit;
+            needed--;
         }
+        if (!request) continue;
+
+        NackEntry entry;
+        entry.frame_id = frame.frame_id;
+        entry.group_index = static_cast<uint16_t>(g);
+        entry.budget_ms = static_cast<uint16_t>(std::min<int64_t>(budget, UINT16_MAX));
+        entry.missing_mask = request;
+        nack_handler_(entry);
+        nacks_sent_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+uint8_t* SmartFrameCollector::block_ptr(PartialFrame& frame, int group, int index) const {
+    size_t slot = index < frame.k ? static_cast<size_t>(group) * frame.k + index
+                                  : static_cast<size_t>(frame.group_count) * frame.k + group * frame.r + (index - frame.k);
+    return frame.blocks.data() + slot * frame.block_size;
+}
+
+// Rebuilds the group's missing data blocks inside the frame's own block matrix
+bool SmartFrameCollector::decode_group(PartialFrame& frame, int group) {
+    uint8_t* block_ptrs[ErasureCoder::MAX_BLOCKS];
+    for (int i = 0; i < frame.k + frame.r; ++i)
+        block_ptrs[i] = block_ptr(frame, group, i);
+
+    return frame.fec->decode_in_place(block_ptrs, frame.group_masks[group], frame.block_size);
+}
+
+// One coder per FEC shape seen on the wire, created on first use
+ErasureCoder* SmartFrameCollector::coder_for(int k, int r) {
+    auto key = std::make_pair(k, r);
+    auto it = coders_.find(key);
+    if (it != coders_.end()) {
+        if (!it->second) reject_shape(k, r, nullptr);
+        return it->second.get();
+    }
+
+    // Out-of-range shapes never reach the coder, so a hostile header cannot grow the map
+    if (k <= 0 || r <= 0 || k + r > ErasureCoder::MAX_BLOCKS) {
+        reject_shape(k, r, "k, r must be positive with k + r <= 64");
+        return nullptr;
+    }
+
+    // A shape that failed once is cached as nullptr: the matrix is never rebuilt for it
+    std::unique_ptr<ErasureCoder> coder;
+    try {
+        coder = std::make_unique<ErasureCoder>(k, r);
+    } catch (const std::exception& e) {
+        reject_shape(k, r, e.what());
+    }
+    ErasureCoder* ptr = coder.get();
+    coders_.emplace(key, std::move(coder));
+    return ptr;
+}
+
+void SmartFrameCollector::reject_shape(int k, int r, const char* reason) {
+    shape_rejections_++;
+    TimePoint now = Clock::now();
+    if (have_shape_log_ && now - last_shape_log_ < std::chrono::milliseconds(SHAPE_LOG_INTERVAL_MS)) {
+        shape_log_suppressed_++;
+        return;
     }
+    std::cerr << "[COLLECTOR] Unsupported FEC shape k=" << k << " r=" << r;
+    if (reason) std::cerr << ": " << reason;
+    if (shape_log_suppressed_) std::cerr << " (" << shape_log_suppressed_ << " more since last report)";
+    std::cerr << std::endl;
+    last_shape_log_ = now;
+    have_shape_log_ = true;
+    shape_log_suppressed_ = 0;
 }
 
+void SmartFrameCollector::flush_expired_frames() {
+    check_owner();
+    deadlines_.advance(Clock::now(), on_deadline_);
+    // Abandoned or skipped frames may have unblocked the frames queued behind them
+    release_ready();
+}
+
+int SmartFrameCollector::poll_timeout_ms(int max_ms) const {
+    check_owner();
+    return deadlines_.ms_until_next(max_ms);
+}
@@ -0,0 +1,145 @@
+#include "timer_wheel.hpp"
+#include <algorithm>
+
+constexpr uint64_t MAX_DELTA_TICKS = (uint64_t(1) << (TimerWheel::SLOT_BITS * TimerWheel::LEVELS)) - 1;
+
+TimerWheel::TimerWheel(Clock::time_point start) : start_(start) {
+    for (auto& level : slots_) level.fill(-1);
+}
+
+uint64_t TimerWheel::tick_of(Clock::time_point t) const {
+    if (t <= start_) return 0;
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(t - start_).count());
+}
+
+TimerWheel::TimerId TimerWheel::schedule(Clock::time_point deadline, uint64_t tag) {
+    int32_t index;
+    if (!free_.empty()) {
+        index = free_.back();
+        free_.pop_back();
+    } else {
+        index = static_cast<int32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+
+    Node& node = nodes_[index];
+    // Round up: a timer never fires before its deadline
+    uint64_t expires = tick_of(deadline);
+    if (deadline > start_ + std::chrono::milliseconds(expires)) expires++;
+    node.expires = std::min(expires, current_tick_ + MAX_DELTA_TICKS);
+    node.tag = tag;
+    node.armed = true;
+    armed_++;
+    insert(index);
+
+    return (static_cast<uint64_t>(node.generation) << 32) | static_cast<uint32_t>(index);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    if (id == 0) return false;
+    uint32_t index = static_cast<uint32_t>(id);
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+    if (index >= nodes_.size()) return false;
+
+    Node& node = nodes_[index];
+    if (!node.armed || node.generation != generation) return false;
+
+    // The node stays linked until its slot is visited
+    node.armed = false;
+    node.generation++;
+    armed_--;
+    return true;
+}
+
+void TimerWheel::insert(int32_t index) {
+    Node& node = nodes_[index];
+    uint64_t expires = std::max(node.expires, current_tick_);
+    uint64_t delta = expires - current_tick_;
+
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) level++;
+
+    int slot = static_cast<int>((expires >> (SLOT_BITS * level)) & (SLOTS - 1));
+    node.next = slots_[level][slot];
+    slots_[level][slot] = index;
+}
+
+void TimerWheel::release(int32_t index) {
+    nodes_[index].next = -1;
+    free_.push_back(index);
+}
+
+// Moves one slot of a coarse level down to the finer levels
+void TimerWheel::cascade(int level, int slot) {
+    int32_t index = slots_[level][slot];
+    slots_[level][slot] = -1;
+
+    while (index >= 0) {
+        int32_t next = nodes_[index].next;
+        if (nodes_[index].armed) insert(index);
+        else release(index);
+        index = next;
+    }
+}
+
+size_t TimerWheel::advance(Clock::time_point now, const ExpireHandler& handler) {
+    const uint64_t target = tick_of(now);
+    size_t fired = 0;
+
+    while (current_tick_ <= target) {
+        const uint64_t tick = current_tick_;
+
+        // Crossing a level boundary pulls the next coarse slot down, highest first
+        if (tick > 0 && (tick & (SLOTS - 1)) == 0) {
+            int top = 1;
+            while (top < LEVELS - 1 && ((tick >> (SLOT_BITS * top)) & (SLOTS - 1)) == 0) top++;
+            for (int level = top; level >= 1; --level)
+                cascade(level, static_cast<int>((tick >> (SLOT_BITS * level)) & (SLOTS - 1)));
+        }
+
+        const int slot = static_cast<int>(tick & (SLOTS - 1));
+        int32_t index = slots_[0][slot];
+        slots_[0][slot] = -1;
+
+        // Timers scheduled from the handler land on the next tick at the earliest
+        current_tick_ = tick + 1;
+
+        while (index >= 0) {
+            Node& node = nodes_[index];
+            int32_t next = node.next;
+            if (node.armed) {
+                uint64_t tag = node.tag;
+                node.armed = false;
+                node.generation++;
+                armed_--;
+                release(index);
+                handler(tag);
+                fired++;
+            } else {
+                release(index);
+            }
+            index = next;
+        }
+    }
+
+    return fired;
+}
+
+int TimerWheel::ms_until_next(int max_ms, Clock::time_point now) const {
+    if (armed_ == 0) return max_ms;
+
+    const uint64_t now_tick = tick_of(now);
+    const uint64_t horizon = now_tick + static_cast<uint64_t>(std::max(max_ms, 0));
+    auto wait = [now_tick](uint64_t tick) {
+        return tick <= now_tick ? 0 : static_cast<int>(tick - now_tick);
+    };
+
+    // Scan the fine level only up to the next cascade point; a cascade may bring
+    // a timer due right at the boundary, so report the boundary as a possible wakeup
+    for (uint64_t tick = current_tick_; tick < horizon; ++tick) {
+        if (tick > current_tick_ && (tick & (SLOTS - 1)) == 0) return wait(tick);
+        if (slots_[0][tick & (SLOTS - 1)] >= 0) return wait(tick);
+    }
+    return max_ms;
+}
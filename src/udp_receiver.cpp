@@ -0,0 +1,149 @@
+#include "udp_receiver.hpp"
+#include <sys/epoll.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <cstdio>
+#include <iostream>
+
+UdpReceiver::UdpReceiver()
+    : buffers_(BATCH_SIZE * MAX_DATAGRAM), iovs_(BATCH_SIZE), msgs_(BATCH_SIZE), addrs_(BATCH_SIZE) {
+    for (unsigned int i = 0; i < BATCH_SIZE; ++i) {
+        iovs_[i].iov_base = buffers_.data() + i * MAX_DATAGRAM;
+        iovs_[i].iov_len = MAX_DATAGRAM;
+    }
+}
+
+UdpReceiver::~UdpReceiver() {
+    close();
+}
+
+bool UdpReceiver::open(const std::vector<int>& ports) {
+    close();
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        perror("[udp_receiver] epoll_create1 failed");
+        return false;
+    }
+
+    for (int port : ports) {
+        int sock = socket(AF_INET, SOCK_DGRAM, 0);
+        if (sock < 0) {
+            perror("[udp_receiver] Socket creation failed");
+            close();
+            return false;
+        }
+
+        // Large receive buffer absorbs bursty I-frames between wakeups
+        int recvbuf = 4 * 1024 * 1024;
+        setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &recvbuf, sizeof(recvbuf));
+
+        int flags = fcntl(sock, F_GETFL, 0);
+        fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = INADDR_ANY;
+        if (bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            perror("[udp_receiver] bind failed");
+            ::close(sock);
+            close();
+            return false;
+        }
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u32 = static_cast<uint32_t>(sockets_.size());
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, sock, &ev) < 0) {
+            perror("[udp_receiver] epoll_ctl failed");
+            ::close(sock);
+            close();
+            return false;
+        }
+
+        sockets_.push_back({sock, port});
+        std::cout << "Listening UDP " << port << std::endl;
+    }
+
+    return true;
+}
+
+void UdpReceiver::close() {
+    for (const auto& s : sockets_)
+        ::close(s.fd);
+    sockets_.clear();
+
+    if (epoll_fd_ >= 0) {
+        ::close(epoll_fd_);
+        epoll_fd_ = -1;
+    }
+}
+
+int UdpReceiver::poll(int timeout_ms, const DatagramHandler& handler) {
+    if (epoll_fd_ < 0) return -1;
+
+    epoll_event events[16];
+    int n = epoll_wait(epoll_fd_, events, 16, timeout_ms);
+    if (n < 0) {
+        if (errno == EINTR) return 0;
+        perror("[udp_receiver] epoll_wait failed");
+        return -1;
+    }
+
+    int total = 0;
+    for (int i = 0; i < n; ++i) {
+        uint32_t index = events[i].data.u32;
+        if (index < sockets_.size())
+            total += drain(sockets_[index], handler);
+    }
+    return total;
+}
+
+int UdpReceiver::drain(const Socket& sock, const DatagramHandler& handler) {
+    int total = 0;
+
+    for (int round = 0; round < MAX_DRAIN_ROUNDS; ++round) {
+        for (unsigned int i = 0; i < BATCH_SIZE; ++i) {
+            msgs_[i] = {};
+            msgs_[i].msg_hdr.msg_iov = &iovs_[i];
+            msgs_[i].msg_hdr.msg_iovlen = 1;
+            msgs_[i].msg_hdr.msg_name = &addrs_[i];
+            msgs_[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        }
+
+        int received = recvmmsg(sock.fd, msgs_.data(), BATCH_SIZE, MSG_DONTWAIT, nullptr);
+        if (received < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                perror("[udp_receiver] recvmmsg failed");
+            break;
+        }
+
+        for (int i = 0; i < received; ++i) {
+            // Truncated datagrams are larger than any packet we produce
+            if (msgs_[i].msg_hdr.msg_flags & MSG_TRUNC) continue;
+            handler(static_cast<const uint8_t*>(iovs_[i].iov_base), msgs_[i].msg_len, sock.port, addrs_[i]);
+        }
+        total += received;
+
+        // Socket is drained when the kernel could not fill a whole batch
+        if (received < static_cast<int>(BATCH_SIZE)) break;
+    }
+
+    return total;
+}
+
+ssize_t UdpReceiver::send_to(int port, const sockaddr_in& to, const uint8_t* data, size_t len) {
+    for (const auto& s : sockets_) {
+        if (s.port != port) continue;
+        ssize_t sent = sendto(s.fd, data, len, MSG_DONTWAIT,
+                              reinterpret_cast<const sockaddr*>(&to), sizeof(to));
+        if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+            perror("[udp_receiver] sendto failed");
+        return sent;
+    }
+    return -1;
+}
@@ -1,4 +1,5 @@
 #include "udp_sender.hpp"
+#include "network_impairment.hpp"
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -9,19 +10,32 @@
 #include <errno.h>
 #include <chrono>
 #include <thread>
+#include <algorithm>
+#include <cstring>
+#include <sys/uio.h>
+#include <poll.h>
+#include <time.h>
+#if __has_include(<linux/net_tstamp.h>)
+#include <linux/net_tstamp.h>
+#if defined(SO_TXTIME) && defined(SCM_TXTIME)
+#define HAVE_SO_TXTIME 1
+#endif
+#endif
 
-static std::vector<int> udp_sockets;
-static std::vector<std::string> target_ips;
-static std::vector<int> target_ports;
-static std::vector<sockaddr_in> target_addrs;
+constexpr size_t MAX_BATCH_MESSAGES = 1024; // UIO_MAXIOV, kernel limit per sendmmsg
 
-bool init_udp_sockets(const std::vector<int>& local_ports) {
-    udp_sockets.clear();
+UdpSender::~UdpSender() {
+    close();
+}
+
+bool UdpSender::open(const std::vector<int>& local_ports) {
+    close();
 
     for (int port : local_ports) {
         int sock = socket(AF_INET, SOCK_DGRAM, 0);
         if (sock < 0) {
             perror("Socket creation failed");
+            close();
             return false;
         }
         
@@ -44,76 +58,106 @@ bool init_udp_sockets(const std::vector<int>& local_ports) {
         addr.sin_addr.s_addr = INADDR_ANY;
         if (bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
             perror("bind failed");
-            close(sock);
+            ::close(sock);
+            close();
             return false;
         }
-        
-        udp_sockets.push_back(sock);
+
+        // Port 0: report the port the kernel picked, feedback is tagged with it
+        socklen_t addr_len = sizeof(addr);
+        if (port == 0 && getsockname(sock, reinterpret_cast<sockaddr*>(&addr), &addr_len) == 0)
+            port = ntohs(addr.sin_port);
+
+        sockets_.push_back(sock);
+        local_ports_.push_back(port);
     }
 
     std::cout << "[udp_sender] ✅ " << local_ports.size() << " UDP sockets prepared for bidirectional communication.\n";
     return true;
 }
 
-void close_udp_sockets() {
-    for (int sock : udp_sockets)
-        close(sock);
+void UdpSender::close() {
+    // Nothing may be released into a closed socket
+    if (impairment_) {
+        impairment_->stop();
+        impairment_.reset();
+    }
+    if (sockets_.empty()) return;
+
+    for (int sock : sockets_)
+        ::close(sock);
 
-    udp_sockets.clear();
-    target_addrs.clear();
+    sockets_.clear();
+    local_ports_.clear();
+    target_addrs_.clear();
+    target_ips_.clear();
+    target_ports_.clear();
+    txtime_enabled_ = false;
     std::cout << "[udp_sender] All UDP sockets closed.\n";
 }
 
 // Pre-compute target addresses for zero-copy optimization
-void set_target_addresses(const std::string& target_ip, const std::vector<int>& ports) {
-    target_addrs.clear();
-    target_ips.clear();
-    target_ports.clear();
+void UdpSender::set_targets(const std::string& target_ip, const std::vector<int>& ports) {
+    target_addrs_.clear();
+    target_ips_.clear();
+    target_ports_.clear();
     
     for (int port : ports) {
         sockaddr_in addr{};
         addr.sin_family = AF_INET;
         addr.sin_port = htons(port);
         inet_pton(AF_INET, target_ip.c_str(), &addr.sin_addr);
-        target_addrs.push_back(addr);
-        target_ips.push_back(target_ip);
-        target_ports.push_back(port);
+        target_addrs_.push_back(addr);
+        target_ips_.push_back(target_ip);
+        target_ports_.push_back(port);
     }
 }
 
-ssize_t send_udp(const std::string& target_ip, int port, const ChunkPacket& packet) {
-    if (udp_sockets.empty()) return -1;
-
-    // Find the target address
-    size_t addr_index = 0;
-    bool found = false;
-    for (size_t i = 0; i < target_ports.size(); ++i) {
-        if (target_ports[i] == port && target_ips[i] == target_ip) {
-            addr_index = i;
-            found = true;
-            break;
-        }
-    }
-    
-    if (!found) {
-        // Add new target address
-        sockaddr_in addr{};
-        addr.sin_family = AF_INET;
-        addr.sin_port = htons(port);
-        inet_pton(AF_INET, target_ip.c_str(), &addr.sin_addr);
-        target_addrs.push_back(addr);
-        target_ips.push_back(target_ip);
-        target_ports.push_back(port);
-        addr_index = target_addrs.size() - 1;
+// Find the pre-computed target address, adding it on first use
+size_t UdpSender::target_index(const std::string& target_ip, int port) {
+    for (size_t i = 0; i < target_ports_.size(); ++i) {
+        if (target_ports_[i] == port && target_ips_[i] == target_ip)
+            return i;
     }
 
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, target_ip.c_str(), &addr.sin_addr);
+    target_addrs_.push_back(addr);
+    target_ips_.push_back(target_ip);
+    target_ports_.push_back(port);
+    return target_addrs_.size() - 1;
+}
+
+ssize_t UdpSender::send(const std::string& target_ip, int port, const ChunkPacket& packet) {
+    if (sockets_.empty()) return -1;
+
+    size_t addr_index = target_index(target_ip, port);
+
     // Select socket using round-robin for load balancing
-    static size_t socket_index = 0;
-    int sock = udp_sockets[socket_index % udp_sockets.size()];
-    socket_index++;
+    int sock = sockets_[next_socket_ % sockets_.size()];
+    next_socket_++;
 
-    // Serialize packet
-    std::vector<uint8_t> buffer = serialize_packet(packet);
+    // Header on the stack, payload sent straight from the packet (no serialize copy)
+    uint8_t header[PACKET_HEADER_SIZE];
+    write_packet_header(packet, header);
+
+    iovec iov[2] = {
+        {header, PACKET_HEADER_SIZE},
+        {const_cast<uint8_t*>(packet.payload.data()), packet.payload.size()},
+    };
+
+    if (impairment_) {
+        impairment_->submit(addr_index, sock, target_addrs_[addr_index], iov, 2);
+        return static_cast<ssize_t>(PACKET_HEADER_SIZE + packet.payload.size());
+    }
+
+    msghdr msg{};
+    msg.msg_name = &target_addrs_[addr_index];
+    msg.msg_namelen = sizeof(sockaddr_in);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
 
     // Non-blocking send with retry
     ssize_t sent = 0;
@@ -121,9 +165,7 @@ ssize_t send_udp(const std::string& target_ip, int port, const ChunkPacket& pack
     const int max_retries = 3;
     
     while (retries < max_retries) {
-        sent = sendto(sock, buffer.data(), buffer.size(), MSG_DONTWAIT,
-                      reinterpret_cast<sockaddr*>(&target_addrs[addr_index]), 
-                      sizeof(sockaddr_in));
+        sent = sendmsg(sock, &msg, MSG_DONTWAIT);
         
         if (sent >= 0) {
             break; // Success
@@ -148,16 +190,16 @@ ssize_t send_udp(const std::string& target_ip, int port, const ChunkPacket& pack
 }
 
 // Enhanced send with multiple paths for redundancy
-ssize_t send_udp_multipath(const std::string& target_ip, const std::vector<int>& ports, 
-                          const ChunkPacket& packet) {
-    if (udp_sockets.empty()) return -1;
+ssize_t UdpSender::send_multipath(const std::string& target_ip, const std::vector<int>& ports,
+                                 const ChunkPacket& packet) {
+    if (sockets_.empty()) return -1;
 
     ssize_t total_sent = 0;
     std::vector<ssize_t> sent_per_path;
     
     // Send to all paths for redundancy
     for (int port : ports) {
-        ssize_t sent = send_udp(target_ip, port, packet);
+        ssize_t sent = send(target_ip, port, packet);
         sent_per_path.push_back(sent);
         if (sent > 0) total_sent += sent;
     }
@@ -175,3 +217,179 @@ ssize_t send_udp_multipath(const std::string& target_ip, const std::vector<int>&
     
     return total_sent;
 }
+
+void UdpSender::set_impairment(std::shared_ptr<NetworkImpairment> impairment) {
+    impairment_ = std::move(impairment);
+}
+
+bool UdpSender::enable_txtime() {
+#ifdef HAVE_SO_TXTIME
+    if (sockets_.empty()) return false;
+
+    // steady_clock is CLOCK_MONOTONIC on Linux, so pacer time points map straight to txtime
+    sock_txtime config{};
+    config.clockid = CLOCK_MONOTONIC;
+    config.flags = 0;
+    for (int sock : sockets_) {
+        if (setsockopt(sock, SOL_SOCKET, SO_TXTIME, &config, sizeof(config)) < 0) {
+            perror("[udp_sender] SO_TXTIME not available");
+            return false;
+        }
+    }
+    txtime_enabled_ = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Batched send: every (path, packet) pair assigned to a socket goes out in one sendmmsg.
+// Each datagram is gathered from a header slot and the caller's payload memory.
+BatchSendResult UdpSender::send_batch(const std::string& target_ip, const std::vector<int>& ports,
+                                      const std::vector<PacketView>& packets,
+                                      const int64_t* departure_ns) {
+    BatchSendResult result;
+    result.datagrams_per_path.assign(ports.size(), 0);
+    if (sockets_.empty() || ports.empty() || packets.empty()) return result;
+
+    BatchScratch& scratch = scratch_;
+
+    // Headers are written once, shared by every path
+    scratch.headers.resize(packets.size() * PACKET_HEADER_SIZE);
+    for (size_t i = 0; i < packets.size(); ++i)
+        write_packet_header(packets[i], &scratch.headers[i * PACKET_HEADER_SIZE]);
+
+    size_t path_count = ports.size();
+    scratch.addr_indices.resize(path_count);
+    for (size_t p = 0; p < path_count; ++p)
+        scratch.addr_indices[p] = target_index(target_ip, ports[p]);
+
+    for (size_t s = 0; s < sockets_.size() && s < path_count; ++s) {
+        int sock = sockets_[s];
+
+        scratch.iovs.clear();
+        scratch.msg_path.clear();
+        scratch.msg_packet.clear();
+        for (size_t p = s; p < path_count; p += sockets_.size()) {
+            for (size_t i = 0; i < packets.size(); ++i) {
+                scratch.iovs.push_back({&scratch.headers[i * PACKET_HEADER_SIZE], PACKET_HEADER_SIZE});
+                scratch.iovs.push_back({const_cast<uint8_t*>(packets[i].payload), packets[i].payload_size});
+                scratch.msg_path.push_back(p);
+                scratch.msg_packet.push_back(i);
+            }
+        }
+
+        std::vector<mmsghdr>& msgs = scratch.msgs;
+        msgs.resize(scratch.msg_path.size());
+        for (size_t m = 0; m < msgs.size(); ++m) {
+            msgs[m] = {};
+            msgs[m].msg_hdr.msg_name = &target_addrs_[scratch.addr_indices[scratch.msg_path[m]]];
+            msgs[m].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            msgs[m].msg_hdr.msg_iov = &scratch.iovs[m * 2];
+            msgs[m].msg_hdr.msg_iovlen = 2;
+        }
+
+        // Emulated network: the shim takes every datagram and decides its fate; the kernel
+        // sees them later from the shim's thread. Pacing departure times do not apply.
+        if (impairment_) {
+            for (size_t m = 0; m < msgs.size(); ++m) {
+                const size_t path = scratch.msg_path[m];
+                impairment_->submit(path, sock, target_addrs_[scratch.addr_indices[path]],
+                                       msgs[m].msg_hdr.msg_iov, 2);
+                result.datagrams_per_path[path]++;
+                result.bytes_sent += PACKET_HEADER_SIZE + packets[scratch.msg_packet[m]].payload_size;
+            }
+            result.datagrams_sent += msgs.size();
+            continue;
+        }
+
+#ifdef HAVE_SO_TXTIME
+        // One SCM_TXTIME control message per datagram carrying its departure time
+        if (departure_ns && txtime_enabled_) {
+            const size_t space = CMSG_SPACE(sizeof(uint64_t));
+            scratch.controls.assign(msgs.size() * space, 0);
+            for (size_t m = 0; m < msgs.size(); ++m) {
+                msghdr& hdr = msgs[m].msg_hdr;
+                hdr.msg_control = &scratch.controls[m * space];
+                hdr.msg_controllen = space;
+                cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+                cmsg->cmsg_level = SOL_SOCKET;
+                cmsg->cmsg_type = SCM_TXTIME;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+                uint64_t txtime = static_cast<uint64_t>(departure_ns[scratch.msg_packet[m]]);
+                std::memcpy(CMSG_DATA(cmsg), &txtime, sizeof(txtime));
+            }
+        }
+#endif
+
+        // Non-blocking send with retry; a partial send resumes from the first unsent message
+        size_t done = 0;
+        int retries = 0;
+        const int max_retries = 3;
+
+        while (done < msgs.size() && retries < max_retries) {
+            unsigned int vlen = static_cast<unsigned int>(std::min(msgs.size() - done, MAX_BATCH_MESSAGES));
+            int sent = sendmmsg(sock, &msgs[done], vlen, MSG_DONTWAIT);
+
+            if (sent > 0) {
+                for (int m = 0; m < sent; ++m) {
+                    result.datagrams_per_path[scratch.msg_path[done + m]]++;
+                    result.bytes_sent += msgs[done + m].msg_len;
+                }
+                result.datagrams_sent += sent;
+                done += sent;
+                continue;
+            }
+
+            if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                perror("[udp_sender] Batch send error");
+                break;
+            }
+
+            // Buffer full, try again after a short delay
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            retries++;
+        }
+
+        if (done < msgs.size()) {
+            std::cerr << "[udp_sender] Batch send incomplete on socket " << s << ": "
+                      << done << "/" << msgs.size() << " datagrams" << std::endl;
+        }
+    }
+
+    return result;
+}
+
+int UdpSender::poll_feedback(int timeout_ms, const FeedbackHandler& handler) {
+    if (sockets_.empty()) return -1;
+
+    std::vector<pollfd>& fds = poll_fds_;
+    fds.resize(sockets_.size());
+    for (size_t i = 0; i < sockets_.size(); ++i)
+        fds[i] = {sockets_[i], POLLIN, 0};
+
+    int ready = ::poll(fds.data(), fds.size(), timeout_ms);
+    if (ready < 0) {
+        if (errno == EINTR) return 0;
+        perror("[udp_sender] poll failed");
+        return -1;
+    }
+
+    // Feedback is small and rare next to media: plain recv until the socket is empty
+    uint8_t* buffer = feedback_buffer_;
+    int total = 0;
+    for (size_t i = 0; i < fds.size() && ready > 0; ++i) {
+        if (!(fds[i].revents & POLLIN)) continue;
+        for (;;) {
+            ssize_t len = recv(fds[i].fd, buffer, sizeof(feedback_buffer_), MSG_DONTWAIT);
+            if (len < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                    perror("[udp_sender] recv failed");
+                break;
+            }
+            handler(buffer, static_cast<size_t>(len), local_ports_[i]);
+            total++;
+        }
+    }
+    return total;
+}
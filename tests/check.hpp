@@ -0,0 +1,30 @@
+#pragma once
+
+// Testler için küçük denetim makrosu: başarısızlığı yazar, sayar ve devam eder.
+// main() sonunda test_failures() != 0 ise 1 döner.
+
+#include <cstdio>
+
+inline int& test_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        std::fprintf(stderr, "FAIL %s:%d: %s: ", __FILE__, __LINE__, #cond); \
+        std::fprintf(stderr, __VA_ARGS__); \
+        std::fputc('\n', stderr); \
+        ++test_failures(); \
+    } \
+} while (0)
+
+// main()'in son satırı: özet yazar ve çıkış kodunu verir
+inline int test_result(const char* name) {
+    if (test_failures()) {
+        std::fprintf(stderr, "%s: %d check(s) failed\n", name, test_failures());
+        return 1;
+    }
+    std::printf("%s: all checks passed\n", name);
+    return 0;
+}
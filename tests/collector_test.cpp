@@ -0,0 +1,285 @@
+// collector_test: SmartFrameCollector reassembly from packets built the way the sender builds
+// them (systematic RS groups, zero-padded last group). Covers in-order and reordered arrival,
+// duplicates, FEC recovery, multi-group frames, playout order and timing, hostile and oversized
+// headers and a sender restart. Everything runs on the calling thread; only the loss and jitter
+// cases wait on a deadline.
+
+#include "smart_collector.hpp"
+#include "erasure_coder.hpp"
+#include "check.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+constexpr int K = 4;
+constexpr int R = 2;
+constexpr uint16_t BLOCK_SIZE = 256;
+
+// Every packet of one frame, data and parity, in group order
+vector<ChunkPacket> packetize(uint32_t frame_id, const vector<uint8_t>& frame, int k = K, int r = R) {
+    PacketHeader hdr;
+    hdr.k = static_cast<uint8_t>(k);
+    hdr.r = static_cast<uint8_t>(r);
+    hdr.block_size = BLOCK_SIZE;
+    hdr.frame_id = frame_id;
+    hdr.frame_length = static_cast<uint32_t>(frame.size());
+
+    ErasureCoder coder(k, r);
+    vector<ChunkPacket> packets;
+    vector<uint8_t> group(static_cast<size_t>(k + r) * BLOCK_SIZE);
+    for (uint32_t g = 0; g < hdr.group_count(); ++g) {
+        // The last group is zero-padded to k full blocks
+        const size_t offset = static_cast<size_t>(g) * k * BLOCK_SIZE;
+        const size_t bytes = min(frame.size() - offset, static_cast<size_t>(k) * BLOCK_SIZE);
+        fill(group.begin(), group.end(), 0);
+        memcpy(group.data(), frame.data() + offset, bytes);
+
+        uint8_t* blocks[ErasureCoder::MAX_BLOCKS];
+        for (int i = 0; i < k + r; ++i) blocks[i] = &group[i * BLOCK_SIZE];
+        coder.encode(blocks, blocks + k, BLOCK_SIZE);
+
+        for (int i = 0; i < k + r; ++i) {
+            ChunkPacket pkt;
+            static_cast<PacketHeader&>(pkt) = hdr;
+            pkt.group_index = static_cast<uint16_t>(g);
+            pkt.block_index = static_cast<uint8_t>(i);
+            pkt.payload.assign(blocks[i], blocks[i] + BLOCK_SIZE);
+            packets.push_back(move(pkt));
+        }
+    }
+    return packets;
+}
+
+vector<uint8_t> make_frame(uint32_t frame_id, size_t length) {
+    vector<uint8_t> frame(length);
+    for (size_t i = 0; i < length; ++i) frame[i] = static_cast<uint8_t>(frame_id * 31 + i * 7 + (i >> 8));
+    return frame;
+}
+
+// Records every delivered frame
+struct Receiver {
+    vector<vector<uint8_t>> frames;
+    SmartFrameCollector collector;
+
+    Receiver()
+        : collector([this](const uint8_t* data, size_t size) { frames.emplace_back(data, data + size); }, K, R) {}
+};
+
+void in_order() {
+    Receiver rx;
+    for (uint32_t id = 0; id < 40; ++id)   // more frames than slots: the ring wraps
+        for (auto& pkt : packetize(id, make_frame(id, 3 * BLOCK_SIZE + 17))) rx.collector.handle(pkt);
+
+    CHECK(rx.frames.size() == 40, "%zu frames delivered", rx.frames.size());
+    for (uint32_t id = 0; id < rx.frames.size(); ++id)
+        CHECK(rx.frames[id] == make_frame(id, 3 * BLOCK_SIZE + 17), "frame %u corrupted", id);
+    CHECK(rx.collector.systematic_hits() == 40 && rx.collector.reconstructions() == 0,
+          "systematic %llu, reconstructed %llu", static_cast<unsigned long long>(rx.collector.systematic_hits()),
+          static_cast<unsigned long long>(rx.collector.reconstructions()));
+}
+
+// Packets shuffled within and across neighbouring frames, every one sent twice:
+// frames still come out once each, in frame_id order
+void reorder_and_duplicates(mt19937& rng) {
+    Receiver rx;
+    for (uint32_t base = 0; base < 12; base += 3) {
+        vector<ChunkPacket> burst;
+        for (uint32_t id = base; id < base + 3; ++id)
+            for (auto& pkt : packetize(id, make_frame(id, 2 * K * BLOCK_SIZE))) {
+                burst.push_back(pkt);
+                burst.push_back(move(pkt));
+            }
+        shuffle(burst.begin(), burst.end(), rng);
+        for (auto& pkt : burst) rx.collector.handle(pkt);
+    }
+
+    CHECK(rx.frames.size() == 12, "%zu frames delivered", rx.frames.size());
+    for (uint32_t id = 0; id < rx.frames.size(); ++id)
+        CHECK(rx.frames[id] == make_frame(id, 2 * K * BLOCK_SIZE), "frame %u out of order or corrupted", id);
+}
+
+// Up to r blocks lost per group, data or parity: every group decodes, padding is trimmed
+void fec_recovery(mt19937& rng) {
+    Receiver rx;
+    const size_t length = 5 * K * BLOCK_SIZE + 100;   // 6 groups, the last one nearly empty
+    for (uint32_t id = 0; id < 20; ++id) {
+        auto packets = packetize(id, make_frame(id, length));
+        vector<ChunkPacket> kept;
+        for (size_t first = 0; first < packets.size(); first += K + R) {
+            vector<int> order(K + R);
+            for (int i = 0; i < K + R; ++i) order[i] = i;
+            shuffle(order.begin(), order.end(), rng);
+            const int lost = id % (R + 1);
+            for (int i = lost; i < K + R; ++i) kept.push_back(packets[first + order[i]]);
+        }
+        shuffle(kept.begin(), kept.end(), rng);
+        for (auto& pkt : kept) rx.collector.handle(pkt);
+    }
+
+    CHECK(rx.frames.size() == 20, "%zu frames delivered", rx.frames.size());
+    for (uint32_t id = 0; id < rx.frames.size(); ++id)
+        CHECK(rx.frames[id] == make_frame(id, length), "frame %u not recovered", id);
+    CHECK(rx.collector.reconstructions() > 0, "no group went through the decoder");
+}
+
+// A frame that loses more than r blocks in a group is given up at its playout deadline;
+// the complete frames queued behind it are then released
+void unrecoverable_loss() {
+    Receiver rx;
+    auto lost = packetize(0, make_frame(0, K * BLOCK_SIZE));
+    for (int i = R + 1; i < K + R; ++i) rx.collector.handle(lost[i]);
+    for (uint32_t id = 1; id < 4; ++id)
+        for (auto& pkt : packetize(id, make_frame(id, K * BLOCK_SIZE))) rx.collector.handle(pkt);
+    CHECK(rx.frames.empty(), "frames released past a missing one before its deadline");
+
+    const int wait_ms = rx.collector.playout_delay_ms() + 20;
+    this_thread::sleep_for(chrono::milliseconds(wait_ms));
+    rx.collector.flush_expired_frames();
+
+    CHECK(rx.frames.size() == 3, "%zu frames released after the deadline", rx.frames.size());
+    for (uint32_t i = 0; i < rx.frames.size(); ++i)
+        CHECK(rx.frames[i] == make_frame(i + 1, K * BLOCK_SIZE), "frame %u corrupted", i + 1);
+    CHECK(rx.collector.frames_lost() == 1, "%llu frames counted lost",
+          static_cast<unsigned long long>(rx.collector.frames_lost()));
+}
+
+// Sender timestamps 5 ms apart on alternate packets put the jitter estimate well above the
+// fast-path threshold: complete frames are held until their playout time, then come out in
+// order. Without timestamps (every other case) jitter stays 0 and frames leave at once.
+void jitter_holds_release() {
+    Receiver rx;
+    const int64_t base_us = chrono::duration_cast<chrono::microseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+    int sent = 0;
+    for (uint32_t id = 0; id < 8; ++id)
+        for (auto& pkt : packetize(id, make_frame(id, K * BLOCK_SIZE))) {
+            pkt.timestamp = base_us - (sent++ % 2) * 5000;
+            rx.collector.handle(pkt);
+        }
+
+    CHECK(rx.collector.jitter_ms() > SmartFrameCollector::PLAYOUT_FAST_PATH_JITTER_MS,
+          "jitter estimate %.2f ms", rx.collector.jitter_ms());
+    CHECK(rx.frames.size() < 8, "frame 7 released before its playout time");
+
+    this_thread::sleep_for(chrono::milliseconds(rx.collector.playout_delay_ms() + 20));
+    rx.collector.flush_expired_frames();
+    CHECK(rx.frames.size() == 8, "%zu frames released after the playout delay", rx.frames.size());
+    for (uint32_t id = 0; id < rx.frames.size(); ++id)
+        CHECK(rx.frames[id] == make_frame(id, K * BLOCK_SIZE), "frame %u out of order or corrupted", id);
+    CHECK(rx.collector.frames_lost() == 0, "%llu frames counted lost",
+          static_cast<unsigned long long>(rx.collector.frames_lost()));
+}
+
+// Headers that must be ignored without touching the slot's buffers
+void hostile_headers() {
+    Receiver rx;
+    auto packets = packetize(0, make_frame(0, K * BLOCK_SIZE));
+
+    ChunkPacket bad = packets[0];
+    bad.block_index = K + R;                 // one past the group
+    rx.collector.handle(bad);
+    bad.block_index = 255;
+    rx.collector.handle(bad);
+    bad = packets[0];
+    bad.group_index = 1;                     // the frame has a single group
+    rx.collector.handle(bad);
+    bad = packets[0];
+    bad.payload.resize(BLOCK_SIZE - 1);      // payload shorter than block_size
+    rx.collector.handle(bad);
+    bad = packets[0];
+    bad.frame_length = 0;
+    rx.collector.handle(bad);
+
+    for (auto& pkt : packets) rx.collector.handle(pkt);
+    CHECK(rx.frames.size() == 1 && rx.frames[0] == make_frame(0, K * BLOCK_SIZE), "frame damaged by bad headers");
+
+    // Other shapes than the expected one are learnt from the header
+    for (auto& pkt : packetize(1, make_frame(1, 3 * 8 * BLOCK_SIZE), 8, 3)) rx.collector.handle(pkt);
+    CHECK(rx.frames.size() == 2 && rx.frames.back() == make_frame(1, 3 * 8 * BLOCK_SIZE), "(8, 3) frame not delivered");
+
+    // A shape no coder can be built for is rejected per frame, and its failure is cached
+    for (uint32_t id = 2; id < 5; ++id) {
+        auto unsupported = packetize(id, make_frame(id, K * BLOCK_SIZE));
+        for (auto& pkt : unsupported) pkt.r = 0;
+        rx.collector.handle(unsupported[0]);
+    }
+    CHECK(rx.collector.shape_rejections() == 3, "%llu shape rejections",
+          static_cast<unsigned long long>(rx.collector.shape_rejections()));
+    CHECK(rx.frames.size() == 2, "a frame with an unsupported shape was delivered");
+}
+
+// A header whose block matrix would exceed MAX_SLOT_BYTES (one data block and 63 parity
+// blocks per group: ~96 MB for a 1.5 MB frame) is dropped before it can claim a slot, so
+// the frame assembling in that slot survives
+void oversized_matrix() {
+    Receiver rx;
+    auto packets = packetize(0, make_frame(0, K * BLOCK_SIZE));
+    for (int i = 0; i < K - 1; ++i) rx.collector.handle(packets[i]);
+
+    ChunkPacket huge;
+    huge.k = 1;
+    huge.r = 63;
+    huge.block_size = 1512;
+    huge.frame_id = SmartFrameCollector::SLOT_COUNT;   // newer, same slot as frame 0
+    huge.frame_length = 992 * 1512;
+    huge.payload.assign(huge.block_size, 0);
+    static_assert(992 * 64 * 1512 > SmartFrameCollector::MAX_SLOT_BYTES, "shape must be over budget");
+    CHECK(huge.group_count() <= SmartFrameCollector::MAX_GROUPS, "shape must pass the group limit");
+    for (int i = 0; i < 2; ++i) {
+        huge.group_index = static_cast<uint16_t>(i);
+        rx.collector.handle(huge);
+    }
+
+    rx.collector.handle(packets[K - 1]);
+    CHECK(rx.frames.size() == 1 && rx.frames[0] == make_frame(0, K * BLOCK_SIZE),
+          "frame evicted by an oversized header");
+}
+
+// The sender restarts at frame 0 while the receiver's newest id is far ahead: after
+// RESTART_STALE_PACKETS stale packets the ring resets and the new sequence plays out
+void sender_restart() {
+    Receiver rx;
+    for (uint32_t id = 5000; id < 5010; ++id)
+        for (auto& pkt : packetize(id, make_frame(id, K * BLOCK_SIZE))) rx.collector.handle(pkt);
+    CHECK(rx.frames.size() == 10, "%zu frames before the restart", rx.frames.size());
+
+    for (uint32_t id = 0; id < 60; ++id)
+        for (auto& pkt : packetize(id, make_frame(id, K * BLOCK_SIZE))) rx.collector.handle(pkt);
+
+    // Frame 0 and the first block of frame 1 are the stale run; frame 1 is rebuilt from parity
+    const size_t after = rx.frames.size() - 10;
+    CHECK(after == 59, "%zu frames after the restart", after);
+    for (uint32_t i = 0; i < after; ++i)
+        CHECK(rx.frames[10 + i] == make_frame(i + 1, K * BLOCK_SIZE), "frame %u after the restart", i + 1);
+
+    // A lone straggler a full ring behind does not reset the sequence again
+    rx.collector.handle(packetize(10, make_frame(10, K * BLOCK_SIZE))[0]);
+    for (auto& pkt : packetize(60, make_frame(60, K * BLOCK_SIZE))) rx.collector.handle(pkt);
+    CHECK(rx.frames.size() == 70 && rx.frames.back() == make_frame(60, K * BLOCK_SIZE), "sequence broken by a straggler");
+}
+
+} // namespace
+
+int main() {
+    static_assert(SmartFrameCollector::RESTART_STALE_PACKETS > K + R &&
+                  SmartFrameCollector::RESTART_STALE_PACKETS <= 2 * K + R,
+                  "sender_restart assumes the stale run ends inside frame 1");
+    mt19937 rng(0x5107);
+    in_order();
+    reorder_and_duplicates(rng);
+    fec_recovery(rng);
+    unrecoverable_loss();
+    jitter_holds_release();
+    hostile_headers();
+    oversized_matrix();
+    sender_restart();
+    return test_result("collector_test");
+}
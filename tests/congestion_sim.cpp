@@ -0,0 +1,245 @@
+// congestion_sim: DelayGradientController driven through a simulated bottleneck on a
+// virtual clock. Deterministic (fixed seed, no wall-clock reads), so it runs as a CTest.
+//
+// Model: the sender emits 30 frames/s at the controller's target, each frame a burst of
+// 1200-byte packets paced over the frame interval. The bottleneck is a drop-tail FIFO of
+// the given capacity followed by a fixed propagation delay, with optional random loss.
+// Every 100 ms the receiver reports per-frame arrival groups, the interval's loss and the
+// delivered rate, exactly as ReceiverSession/SenderSession do on the wire. ArrivalGroups, which
+// builds those groups on the receiver, is checked on its own.
+
+#include "congestion_controller.hpp"
+#include "feedback.hpp"
+#include "check.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+constexpr int64_t TICK_US = 1000;
+constexpr int64_t REPORT_INTERVAL_US = 100 * 1000;
+constexpr int FPS = 30;
+constexpr int PACKET_BYTES = 1200;
+constexpr int64_t PROPAGATION_US = 20 * 1000;
+constexpr int64_t MAX_QUEUE_US = 300 * 1000;   // drop-tail limit, as queueing delay
+
+struct Phase {
+    int64_t until_ms;
+    double capacity_bps;
+    double random_loss;
+};
+
+// Target bitrate at the end of every report interval
+struct Trace {
+    vector<int64_t> time_ms;
+    vector<double> target_bps;
+    vector<double> queue_ms;
+    int64_t max_queue_ms = 0;
+
+    // Highest / mean target over [from_ms, to_ms)
+    double max_between(int64_t from_ms, int64_t to_ms) const {
+        double m = 0;
+        for (size_t i = 0; i < time_ms.size(); ++i)
+            if (time_ms[i] >= from_ms && time_ms[i] < to_ms) m = max(m, target_bps[i]);
+        return m;
+    }
+    double mean_between(int64_t from_ms, int64_t to_ms) const {
+        double sum = 0;
+        int n = 0;
+        for (size_t i = 0; i < time_ms.size(); ++i)
+            if (time_ms[i] >= from_ms && time_ms[i] < to_ms) { sum += target_bps[i]; ++n; }
+        return n ? sum / n : 0;
+    }
+    // First report at or after from_ms whose target is at or below bps; -1 if none
+    int64_t first_at_or_below(int64_t from_ms, double bps) const {
+        for (size_t i = 0; i < time_ms.size(); ++i)
+            if (time_ms[i] >= from_ms && target_bps[i] <= bps) return time_ms[i];
+        return -1;
+    }
+};
+
+Trace simulate(const vector<Phase>& phases, int initial_bps, uint32_t seed) {
+    DelayGradientController controller(initial_bps, 100000, 8000000);
+    mt19937 rng(seed);
+    uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    Trace trace;
+    const int64_t end_us = phases.back().until_ms * 1000;
+    const int64_t frame_interval_us = 1000000 / FPS;
+
+    int64_t link_free_us = 0;          // when the bottleneck finishes its current backlog
+    int64_t next_frame_us = 0;
+    int64_t next_report_us = REPORT_INTERVAL_US;
+
+    // Packets of the current frame still to be paced out
+    int packets_left = 0;
+    int64_t packet_gap_us = 0;
+    int64_t next_packet_us = 0;
+    int64_t frame_send_us = 0;
+    int64_t frame_last_arrival_us = -1;
+
+    vector<ArrivalSample> arrivals;
+    uint64_t sent = 0, received = 0;
+    double received_bits = 0;
+
+    auto flush_group = [&]() {
+        if (frame_last_arrival_us >= 0) arrivals.push_back({frame_send_us, frame_last_arrival_us});
+        frame_last_arrival_us = -1;
+    };
+
+    size_t phase = 0;
+    for (int64_t now_us = 0; now_us < end_us; now_us += TICK_US) {
+        while (now_us >= phases[phase].until_ms * 1000) ++phase;
+        const Phase& link = phases[phase];
+
+        if (now_us >= next_frame_us) {
+            flush_group();
+            double frame_bits = static_cast<double>(controller.target_bitrate()) / FPS;
+            packets_left = max(1, static_cast<int>(frame_bits / (PACKET_BYTES * 8) + 0.5));
+            packet_gap_us = frame_interval_us / packets_left;
+            next_packet_us = now_us;
+            frame_send_us = now_us;
+            next_frame_us += frame_interval_us;
+        }
+
+        while (packets_left > 0 && next_packet_us <= now_us) {
+            const int64_t send_us = next_packet_us;
+            next_packet_us += packet_gap_us;
+            --packets_left;
+            ++sent;
+
+            const int64_t serialize_us = static_cast<int64_t>(PACKET_BYTES * 8 * 1e6 / link.capacity_bps);
+            const int64_t start_us = max(send_us, link_free_us);
+            if (start_us - send_us > MAX_QUEUE_US) continue;           // queue full
+            link_free_us = start_us + serialize_us;
+            if (uniform(rng) < link.random_loss) continue;              // lost after the queue
+
+            ++received;
+            received_bits += PACKET_BYTES * 8;
+            frame_last_arrival_us = max(frame_last_arrival_us, link_free_us + PROPAGATION_US);
+        }
+
+        if (now_us >= next_report_us) {
+            const int64_t queue_us = max<int64_t>(0, link_free_us - now_us);
+
+            CongestionFeedback feedback;
+            feedback.now_ms = now_us / 1000;
+            feedback.arrivals = arrivals.data();
+            feedback.arrival_count = arrivals.size();
+            feedback.rtt_ms = (2 * PROPAGATION_US + queue_us) / 1000.0;
+            if (sent > 0) {
+                feedback.loss_fraction = 1.0 - static_cast<double>(received) / sent;
+                feedback.received_bps = received_bits * 1e6 / REPORT_INTERVAL_US;
+            }
+            controller.on_feedback(feedback);
+
+            trace.time_ms.push_back(now_us / 1000);
+            trace.target_bps.push_back(controller.target_bitrate());
+            trace.queue_ms.push_back(queue_us / 1000.0);
+            trace.max_queue_ms = max(trace.max_queue_ms, queue_us / 1000);
+
+            arrivals.clear();
+            sent = received = 0;
+            received_bits = 0;
+            next_report_us += REPORT_INTERVAL_US;
+        }
+    }
+    return trace;
+}
+
+void print_trace(const char* name, const Trace& trace) {
+    if (!getenv("CONGESTION_SIM_VERBOSE")) return;
+    for (size_t i = 0; i < trace.time_ms.size(); i += 5)
+        printf("%s t=%6lldms target=%7.0fk queue=%5.1fms\n", name,
+               static_cast<long long>(trace.time_ms[i]), trace.target_bps[i] / 1000, trace.queue_ms[i]);
+}
+
+// Capacity halves (and more): the target must fall under the new capacity within a few
+// report intervals, and the queue the step leaves behind must drain
+void step_down() {
+    const Trace t = simulate({{20000, 4e6, 0.0}, {40000, 1e6, 0.0}}, 1000000, 1);
+    print_trace("step_down", t);
+
+    const double before = t.mean_between(15000, 20000);
+    CHECK(before > 0.6 * 4e6 && before < 1.05 * 4e6, "converged to %.0f bps on a 4 Mbps link", before);
+
+    const int64_t backed_off = t.first_at_or_below(20000, 1e6);
+    CHECK(backed_off >= 0 && backed_off - 20000 <= 30 * 100, "back-off took %lld ms", static_cast<long long>(backed_off - 20000));
+
+    const double after = t.mean_between(30000, 40000);
+    CHECK(after > 0.6 * 1e6 && after < 1.05 * 1e6, "converged to %.0f bps on a 1 Mbps link", after);
+    CHECK(t.max_between(30000, 40000) < 1.2 * 1e6, "peak %.0f bps after settling on 1 Mbps", t.max_between(30000, 40000));
+}
+
+// Capacity quadruples: the target must climb past the old capacity and settle near the new one
+// without overshooting it for long
+void step_up() {
+    const Trace t = simulate({{20000, 1e6, 0.0}, {60000, 4e6, 0.0}}, 500000, 2);
+    print_trace("step_up", t);
+
+    const double before = t.mean_between(15000, 20000);
+    CHECK(before > 0.6 * 1e6 && before < 1.05 * 1e6, "converged to %.0f bps on a 1 Mbps link", before);
+
+    const double after = t.mean_between(50000, 60000);
+    CHECK(after > 0.6 * 4e6 && after < 1.05 * 4e6, "converged to %.0f bps after the step to 4 Mbps", after);
+}
+
+// 3% random loss on a 2 Mbps link: no delay signal to speak of, so loss must hold the rate
+// and the target must not run away past capacity
+void random_loss() {
+    const Trace t = simulate({{40000, 2e6, 0.03}}, 1000000, 3);
+    print_trace("random_loss", t);
+
+    const double settled = t.mean_between(20000, 40000);
+    CHECK(settled > 0.4 * 2e6 && settled < 1.05 * 2e6, "settled at %.0f bps on a lossy 2 Mbps link", settled);
+    CHECK(t.max_queue_ms < MAX_QUEUE_US / 1000, "queue hit the drop-tail limit (%lld ms)", static_cast<long long>(t.max_queue_ms));
+
+    // Heavy loss (20%) on top of the same link: one backoff per reaction time pulls the target down
+    const Trace heavy = simulate({{10000, 2e6, 0.0}, {20000, 2e6, 0.2}}, 1000000, 4);
+    print_trace("heavy_loss", heavy);
+    const double before = heavy.mean_between(9000, 10000);
+    const int64_t backed_off = heavy.first_at_or_below(10000, 0.9 * before);
+    CHECK(backed_off >= 0 && backed_off - 10000 <= 10 * 100, "20%% loss back-off took %lld ms", static_cast<long long>(backed_off - 10000));
+    CHECK(heavy.mean_between(15000, 20000) < 0.7 * before, "target %.0f bps under 20%% loss", heavy.mean_between(15000, 20000));
+}
+
+// The receiver side of the same feedback: packets sent within GROUP_SPAN_US form one group,
+// represented by its last send and last arrival; reordering into a closed group is ignored
+void arrival_grouping() {
+    ArrivalGroups groups;
+    groups.on_packet(1000, 50000);
+    groups.on_packet(2000, 50400);
+    groups.on_packet(1500, 50900);                              // reordered inside the group
+    groups.on_packet(1000 + ArrivalGroups::GROUP_SPAN_US + 1, 56000);   // opens the next group
+    groups.on_packet(500, 57000);                               // belongs to a closed group
+
+    ArrivalSample out[MAX_REPORT_ARRIVALS];
+    size_t n = groups.take(out, MAX_REPORT_ARRIVALS);
+    CHECK(n == 1, "%zu closed groups, expected 1 (the open one is not reported)", n);
+    if (n == 1) CHECK(out[0].send_us == 2000 && out[0].arrival_us == 50900, "group (%lld, %lld)",
+                      static_cast<long long>(out[0].send_us), static_cast<long long>(out[0].arrival_us));
+    CHECK(groups.take(out, MAX_REPORT_ARRIVALS) == 0, "take() must drain the closed groups");
+
+    // More groups than a report holds: the newest ones are kept
+    for (int g = 0; g < 100; ++g) groups.on_packet(100000 + g * 10000, 200000 + g * 10000);
+    n = groups.take(out, MAX_REPORT_ARRIVALS);
+    CHECK(n == MAX_REPORT_ARRIVALS, "%zu groups taken", n);
+    if (n == MAX_REPORT_ARRIVALS) CHECK(out[n - 1].send_us == 100000 + 98 * 10000, "newest closed group missing");
+}
+
+} // namespace
+
+int main() {
+    step_down();
+    step_up();
+    random_loss();
+    arrival_grouping();
+    return test_result("congestion_sim");
+}
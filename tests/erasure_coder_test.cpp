@@ -0,0 +1,172 @@
+// erasure_coder_test: ErasureCoder's GF(2^8) kernels must stay bit-exact with Jerasure,
+// because the sender and receiver may be different builds and the parity is on the wire.
+// Every (k, r) shape below is encoded and decoded through both implementations. The decode
+// matrix cache is checked separately: hits, LRU eviction, and correct output from cached matrices.
+
+#include "erasure_coder.hpp"
+#include "gf256.hpp"
+#include "check.hpp"
+
+#include <jerasure.h>
+#include <reed_sol.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+constexpr size_t BLOCK_SIZE = 1024 + 13;   // odd size exercises the SIMD tail path
+
+void check_shape(int k, int r, mt19937& rng) {
+    ErasureCoder coder(k, r);
+    int* matrix = reed_sol_vandermonde_coding_matrix(k, r, 8);
+    CHECK(matrix != nullptr, "no Jerasure matrix for k=%d r=%d", k, r);
+    if (!matrix) return;
+
+    uniform_int_distribution<int> byte(0, 255);
+    vector<vector<uint8_t>> data(k, vector<uint8_t>(BLOCK_SIZE));
+    for (auto& block : data)
+        for (auto& b : block) b = static_cast<uint8_t>(byte(rng));
+
+    // Encode: ours vs jerasure_matrix_encode
+    vector<vector<uint8_t>> ours;
+    coder.encode(data, ours);
+
+    vector<vector<uint8_t>> ref = ours;
+    vector<char*> data_ptrs(k), code_ptrs(r);
+    for (int i = 0; i < k; ++i) data_ptrs[i] = reinterpret_cast<char*>(ref[i].data());
+    for (int i = 0; i < r; ++i) {
+        fill(ref[k + i].begin(), ref[k + i].end(), 0);
+        code_ptrs[i] = reinterpret_cast<char*>(ref[k + i].data());
+    }
+    jerasure_matrix_encode(k, r, 8, matrix, data_ptrs.data(), code_ptrs.data(), BLOCK_SIZE);
+    CHECK(ref == ours, "encode differs from Jerasure for k=%d r=%d", k, r);
+
+    // Decode: every erasure count 1..r, leading data blocks plus a random pattern
+    for (int erased = 1; erased <= r; ++erased) {
+        for (int pattern = 0; pattern < 2; ++pattern) {
+            vector<bool> received(k + r, true);
+            if (pattern == 0) {
+                for (int i = 0; i < erased && i < k; ++i) received[i] = false;
+            } else {
+                vector<int> idx(k + r);
+                for (int i = 0; i < k + r; ++i) idx[i] = i;
+                shuffle(idx.begin(), idx.end(), rng);
+                for (int i = 0; i < erased; ++i) received[idx[i]] = false;
+            }
+
+            vector<uint8_t> block_matrix((k + r) * BLOCK_SIZE, 0);
+            vector<int> erasures;
+            uint64_t mask = 0;
+            uint8_t* block_ptrs[ErasureCoder::MAX_BLOCKS];
+            for (int i = 0; i < k + r; ++i) {
+                block_ptrs[i] = &block_matrix[i * BLOCK_SIZE];
+                if (received[i]) {
+                    copy(ours[i].begin(), ours[i].end(), block_ptrs[i]);
+                    mask |= uint64_t(1) << i;
+                } else {
+                    erasures.push_back(i);
+                }
+            }
+            erasures.push_back(-1);
+
+            vector<uint8_t> jer = block_matrix;
+            for (int i = 0; i < k; ++i) data_ptrs[i] = reinterpret_cast<char*>(&jer[i * BLOCK_SIZE]);
+            for (int i = 0; i < r; ++i) code_ptrs[i] = reinterpret_cast<char*>(&jer[(k + i) * BLOCK_SIZE]);
+            int ret = jerasure_matrix_decode(k, r, 8, matrix, 0, erasures.data(),
+                                             data_ptrs.data(), code_ptrs.data(), BLOCK_SIZE);
+            CHECK(ret >= 0, "Jerasure decode failed for k=%d r=%d erased=%d", k, r, erased);
+
+            bool ok = coder.decode_in_place(block_ptrs, mask, BLOCK_SIZE);
+            CHECK(ok, "decode_in_place failed for k=%d r=%d erased=%d", k, r, erased);
+            CHECK(equal(block_matrix.begin(), block_matrix.begin() + k * BLOCK_SIZE, jer.begin()),
+                  "decode differs from Jerasure for k=%d r=%d erased=%d", k, r, erased);
+            for (int i = 0; i < k; ++i)
+                CHECK(equal(data[i].begin(), data[i].end(), block_ptrs[i]),
+                      "block %d not recovered for k=%d r=%d erased=%d", i, k, r, erased);
+        }
+    }
+
+    // Too many erasures must fail rather than produce garbage
+    uint8_t* block_ptrs[ErasureCoder::MAX_BLOCKS];
+    vector<uint8_t> scratch((k + r) * BLOCK_SIZE);
+    for (int i = 0; i < k + r; ++i) block_ptrs[i] = &scratch[i * BLOCK_SIZE];
+    const uint64_t all = (k + r == 64) ? ~uint64_t(0) : (uint64_t(1) << (k + r)) - 1;
+    CHECK(!coder.decode_in_place(block_ptrs, all >> (r + 1), BLOCK_SIZE),
+          "decode with k-1 blocks succeeded for k=%d r=%d", k, r);
+
+    free(matrix);
+}
+
+// k = 8, r = 4: every choice of four erased data blocks is a distinct row set (70 of them),
+// more than DECODE_CACHE_CAPACITY
+void decode_cache(mt19937& rng) {
+    constexpr int k = 8, r = 4;
+    constexpr size_t block_size = 64;
+    ErasureCoder coder(k, r);
+
+    uniform_int_distribution<int> byte(0, 255);
+    vector<vector<uint8_t>> data(k, vector<uint8_t>(block_size));
+    for (auto& block : data)
+        for (auto& b : block) b = static_cast<uint8_t>(byte(rng));
+    vector<vector<uint8_t>> encoded;
+    coder.encode(data, encoded);
+
+    vector<uint64_t> patterns;
+    const uint64_t parity = ((uint64_t(1) << r) - 1) << k;
+    for (uint64_t erased = 0; erased < (uint64_t(1) << k); ++erased)
+        if (__builtin_popcountll(erased) == r) patterns.push_back((~erased & ((uint64_t(1) << k) - 1)) | parity);
+
+    // Decodes with the given blocks erased (zeroed) and checks the data comes back
+    auto decode = [&](uint64_t mask) {
+        vector<vector<uint8_t>> blocks = encoded;
+        uint8_t* ptrs[ErasureCoder::MAX_BLOCKS];
+        for (int i = 0; i < k + r; ++i) {
+            if (!(mask & (uint64_t(1) << i))) fill(blocks[i].begin(), blocks[i].end(), 0);
+            ptrs[i] = blocks[i].data();
+        }
+        bool ok = coder.decode_in_place(ptrs, mask, block_size);
+        for (int i = 0; i < k && ok; ++i) ok = blocks[i] == data[i];
+        CHECK(ok, "decode failed for mask %llx", static_cast<unsigned long long>(mask));
+    };
+    auto counts = [&](uint64_t hits, uint64_t misses) {
+        return coder.cache_hits() == hits && coder.cache_misses() == misses;
+    };
+
+    decode((uint64_t(1) << (k + r)) - 1);
+    CHECK(counts(0, 0), "lossless decode touched the cache");
+
+    decode(patterns[0]);
+    decode(patterns[0]);
+    CHECK(counts(1, 1), "repeat pattern: %llu hits, %llu misses",
+          static_cast<unsigned long long>(coder.cache_hits()), static_cast<unsigned long long>(coder.cache_misses()));
+
+    // Fill the cache, keep patterns[0] recent, then overflow by one: patterns[1] is the LRU entry
+    const size_t capacity = ErasureCoder::DECODE_CACHE_CAPACITY;
+    for (size_t i = 1; i < capacity; ++i) decode(patterns[i]);
+    decode(patterns[0]);
+    decode(patterns[capacity]);
+    CHECK(counts(2, capacity + 1), "after filling: %llu hits, %llu misses",
+          static_cast<unsigned long long>(coder.cache_hits()), static_cast<unsigned long long>(coder.cache_misses()));
+
+    decode(patterns[0]);
+    CHECK(coder.cache_hits() == 3, "recently used entry was evicted");
+    decode(patterns[1]);
+    CHECK(coder.cache_misses() == capacity + 2, "least recently used entry was not evicted");
+}
+
+} // namespace
+
+int main() {
+    printf("gf256 backend: %s\n", gf256_backend());
+    mt19937 rng(0x4E4F5641);
+    const pair<int, int> shapes[] = {{1, 1}, {4, 2}, {8, 2}, {8, 4}, {10, 4}, {16, 8}, {32, 8}, {48, 16}};
+    for (auto [k, r] : shapes) check_shape(k, r, rng);
+    decode_cache(rng);
+    return test_result("erasure_coder_test");
+}
@@ -0,0 +1,131 @@
+// gf256_test: every region kernel the CPU supports (scalar, SSSE3, AVX2, AVX-512) against a
+// byte-at-a-time reference, at every coefficient, many lengths and unaligned offsets, plus
+// matrix inversion. gf256_mul itself is checked against a bitwise carry-less multiply.
+
+#include "gf256.hpp"
+#include "check.hpp"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// Shift-and-add multiply modulo x^8 + x^4 + x^3 + x^2 + 1 (0x11D), independent of the tables
+uint8_t reference_mul(uint8_t a, uint8_t b) {
+    unsigned product = 0, x = a;
+    for (int i = 0; i < 8; ++i) {
+        if (b & (1 << i)) product ^= x << i;
+    }
+    for (int i = 15; i >= 8; --i) {
+        if (product & (1u << i)) product ^= 0x11Du << (i - 8);
+    }
+    return static_cast<uint8_t>(product);
+}
+
+// reference_mul for every pair, so the region checks stay cheap in unoptimized builds
+uint8_t reference_table[256][256];
+
+void scalar_arithmetic() {
+    for (int a = 0; a < 256; ++a)
+        for (int b = 0; b < 256; ++b) reference_table[a][b] = reference_mul(a, b);
+
+    int mismatches = 0;
+    for (int a = 0; a < 256; ++a)
+        for (int b = 0; b < 256; ++b)
+            if (gf256_mul(a, b) != reference_table[a][b]) ++mismatches;
+    CHECK(mismatches == 0, "%d products differ from the reference", mismatches);
+
+    for (int a = 1; a < 256; ++a)
+        CHECK(gf256_mul(a, gf256_inv(a)) == 1, "inv(%d) is wrong", a);
+}
+
+// Lengths around every SIMD width (16/32/64) and their tails, at offsets that break alignment
+void region_kernels(mt19937& rng) {
+    const size_t lengths[] = {0, 1, 7, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 129, 1000, 1037, 4096};
+    const size_t offsets[] = {0, 1, 3, 13};
+    uniform_int_distribution<int> byte(0, 255);
+
+    vector<uint8_t> src(4096 + 64), dst(4096 + 64), expected(4096 + 64);
+    for (auto& b : src) b = static_cast<uint8_t>(byte(rng));
+
+    for (int c = 0; c < 256; ++c) {
+        const uint8_t* times_c = reference_table[c];
+        for (size_t len : lengths) {
+            for (size_t off : offsets) {
+                const uint8_t* in = src.data() + off;
+                uint8_t* out = dst.data() + (off * 7) % 64;
+
+                // dst = c * src; the guard byte past the end must survive
+                for (size_t i = 0; i <= len; ++i) out[i] = static_cast<uint8_t>(byte(rng));
+                const uint8_t guard = out[len];
+                gf256_mul_region(static_cast<uint8_t>(c), in, out, len);
+                bool ok = out[len] == guard;
+                for (size_t i = 0; i < len; ++i) ok &= out[i] == times_c[in[i]];
+                CHECK(ok, "mul_region c=%d len=%zu off=%zu (%s)", c, len, off, gf256_backend());
+
+                // dst ^= c * src
+                for (size_t i = 0; i < len; ++i) {
+                    out[i] = static_cast<uint8_t>(byte(rng));
+                    expected[i] = out[i] ^ times_c[in[i]];
+                }
+                gf256_mul_add_region(static_cast<uint8_t>(c), in, out, len);
+                ok = out[len] == guard && memcmp(out, expected.data(), len) == 0;
+                CHECK(ok, "mul_add_region c=%d len=%zu off=%zu (%s)", c, len, off, gf256_backend());
+            }
+        }
+    }
+}
+
+void matrix_inversion(mt19937& rng) {
+    uniform_int_distribution<int> byte(0, 255);
+    for (int n : {1, 2, 4, 8, 16, 32}) {
+        vector<uint8_t> m(n * n), inv(n * n);
+        bool inverted = false;
+        // Random matrices are almost always invertible; retry the rare singular one
+        for (int attempt = 0; attempt < 10 && !inverted; ++attempt) {
+            for (auto& b : m) b = static_cast<uint8_t>(byte(rng));
+            inverted = gf256_invert_matrix(m.data(), inv.data(), n);
+        }
+        CHECK(inverted, "no invertible %dx%d matrix in 10 attempts", n, n);
+
+        bool identity = true;
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                uint8_t sum = 0;
+                for (int t = 0; t < n; ++t) sum ^= reference_table[m[i * n + t]][inv[t * n + j]];
+                identity &= sum == (i == j ? 1 : 0);
+            }
+        }
+        CHECK(identity, "M * inv(M) != I for n=%d", n);
+
+        // Two equal rows: singular
+        if (n > 1) {
+            memcpy(&m[n], &m[0], n);
+            CHECK(!gf256_invert_matrix(m.data(), inv.data(), n), "singular %dx%d matrix inverted", n, n);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    mt19937 rng(0x6F256);
+    scalar_arithmetic();
+
+    const char* automatic = gf256_backend();
+    for (const char* backend : {"scalar", "ssse3", "avx2", "avx512"}) {
+        if (!gf256_select_backend(backend)) {
+            printf("gf256 backend %s: not supported by this CPU, skipped\n", backend);
+            continue;
+        }
+        printf("gf256 backend %s\n", backend);
+        region_kernels(rng);
+    }
+    gf256_select_backend(automatic);
+
+    matrix_inversion(rng);
+    return test_result("gf256_test");
+}
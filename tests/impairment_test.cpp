@@ -0,0 +1,197 @@
+// impairment_test: NetworkImpairment with a recording sink instead of sockets. Loss,
+// duplication and reordering decisions depend only on the seed, so they are checked exactly;
+// delays and the rate limit run on the wall clock and are checked with generous margins.
+
+#include "network_impairment.hpp"
+#include "check.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+namespace {
+
+// Datagrams as the sink saw them: the sequence number in the payload and the release time
+struct Recorder {
+    mutex lock;
+    vector<uint32_t> seqs;
+    vector<Clock::time_point> times;
+
+    NetworkImpairment::Sink sink() {
+        return [this](int, const sockaddr_in&, const uint8_t* data, size_t len) {
+            uint32_t seq = 0;
+            if (len >= sizeof(seq)) memcpy(&seq, data, sizeof(seq));
+            lock_guard<mutex> guard(lock);
+            seqs.push_back(seq);
+            times.push_back(Clock::now());
+            return true;
+        };
+    }
+};
+
+void submit_seq(NetworkImpairment& net, uint32_t seq, size_t len = 1200) {
+    vector<uint8_t> payload(len, 0);
+    memcpy(payload.data(), &seq, sizeof(seq));
+    // Header and payload in two iovecs, as UdpSender hands them over
+    iovec iov[2] = {{payload.data(), 24}, {payload.data() + 24, len - 24}};
+    net.submit(0, -1, sockaddr_in{}, iov, 2);
+}
+
+// Until every datagram that survived the submit decisions has left the emulator
+bool drain(const NetworkImpairment& net, int timeout_ms = 3000) {
+    auto until = Clock::now() + chrono::milliseconds(timeout_ms);
+    while (Clock::now() < until) {
+        ImpairmentStats s = net.stats(0);
+        if (s.delivered + s.send_errors ==
+            s.submitted - s.lost - s.queue_drops + s.duplicated) return true;
+        this_thread::sleep_for(chrono::milliseconds(2));
+    }
+    return false;
+}
+
+vector<uint32_t> sorted(vector<uint32_t> v) {
+    sort(v.begin(), v.end());
+    return v;
+}
+
+// Same seed, same submissions: same packets lost, duplicated and delivered
+void seed_determinism() {
+    ImpairmentConfig config;
+    config.loss_good = 0.1;
+    config.duplicate = 0.05;
+    config.reorder = 0.05;
+    config.reorder_gap_ms = 1.0;
+
+    vector<uint32_t> runs[3];
+    ImpairmentStats stats[3];
+    const uint64_t seeds[3] = {42, 42, 43};
+    for (int run = 0; run < 3; ++run) {
+        Recorder rec;
+        NetworkImpairment net({config}, seeds[run], rec.sink());
+        for (uint32_t seq = 0; seq < 2000; ++seq) submit_seq(net, seq);
+        CHECK(drain(net), "run %d did not drain", run);
+        net.stop();
+        runs[run] = sorted(rec.seqs);
+        stats[run] = net.stats(0);
+    }
+    CHECK(runs[0] == runs[1], "same seed delivered different packets");
+    CHECK(stats[0].lost == stats[1].lost && stats[0].duplicated == stats[1].duplicated &&
+          stats[0].reordered == stats[1].reordered, "same seed gave different stats");
+    CHECK(runs[0] != runs[2], "different seeds delivered the same packets");
+}
+
+// Independent and Gilbert–Elliott loss at their expected rates; bursts in the bad state
+void loss_rates() {
+    {
+        ImpairmentConfig config;
+        config.loss_good = 0.1;
+        NetworkImpairment net({config}, 7, [](int, const sockaddr_in&, const uint8_t*, size_t) { return true; });
+        for (uint32_t seq = 0; seq < 20000; ++seq) submit_seq(net, seq, 64);
+        const double rate = net.stats(0).lost / 20000.0;
+        CHECK(rate > 0.09 && rate < 0.11, "independent loss %.3f, expected 0.1", rate);
+    }
+
+    // Stationary bad fraction 0.01 / (0.01 + 0.25) ≈ 3.8%, mean burst 1 / 0.25 = 4 packets
+    ImpairmentConfig config;
+    config.good_to_bad = 0.01;
+    config.bad_to_good = 0.25;
+    Recorder rec;
+    NetworkImpairment net({config}, 8, rec.sink());
+    for (uint32_t seq = 0; seq < 50000; ++seq) submit_seq(net, seq, 64);
+    CHECK(drain(net), "bursty run did not drain");
+    net.stop();
+
+    const vector<uint32_t> got = sorted(rec.seqs);
+    int bursts = 0;
+    uint32_t expected = 0;
+    for (uint32_t seq : got) {
+        bursts += seq != expected;
+        expected = seq + 1;
+    }
+    bursts += expected != 50000;
+    const double rate = net.stats(0).lost / 50000.0;
+    const double mean_burst = bursts ? static_cast<double>(net.stats(0).lost) / bursts : 0;
+    CHECK(rate > 0.03 && rate < 0.047, "Gilbert–Elliott loss %.3f, expected ~0.038", rate);
+    CHECK(mean_burst > 3.2 && mean_burst < 4.8, "mean loss burst %.2f packets, expected ~4", mean_burst);
+}
+
+// Copies arrive next to their original; jitter alone keeps order, reordering breaks it
+void duplicates_and_order() {
+    {
+        ImpairmentConfig config;
+        config.duplicate = 0.2;
+        config.delay_ms = 2.0;
+        config.jitter_ms = 2.0;
+        Recorder rec;
+        NetworkImpairment net({config}, 9, rec.sink());
+        for (uint32_t seq = 0; seq < 3000; ++seq) submit_seq(net, seq, 64);
+        CHECK(drain(net), "duplicate run did not drain");
+        net.stop();
+
+        const ImpairmentStats s = net.stats(0);
+        CHECK(s.duplicated > 500 && s.duplicated < 700, "%llu duplicates of 3000, expected ~600",
+              static_cast<unsigned long long>(s.duplicated));
+        CHECK(rec.seqs.size() == 3000 + s.duplicated, "%zu datagrams delivered", rec.seqs.size());
+        CHECK(is_sorted(rec.seqs.begin(), rec.seqs.end()), "jitter without reordering changed the order");
+    }
+
+    ImpairmentConfig config;
+    config.reorder = 0.1;
+    config.reorder_gap_ms = 20.0;
+    Recorder rec;
+    NetworkImpairment net({config}, 10, rec.sink());
+    for (uint32_t seq = 0; seq < 2000; ++seq) submit_seq(net, seq, 64);
+    CHECK(drain(net), "reorder run did not drain");
+    net.stop();
+
+    const ImpairmentStats s = net.stats(0);
+    CHECK(s.reordered > 150 && s.reordered < 250, "%llu reordered of 2000, expected ~200",
+          static_cast<unsigned long long>(s.reordered));
+    vector<uint32_t> expected(2000);
+    for (uint32_t i = 0; i < 2000; ++i) expected[i] = i;
+    CHECK(sorted(rec.seqs) == expected, "reordering lost or duplicated packets");
+    CHECK(!is_sorted(rec.seqs.begin(), rec.seqs.end()), "nothing was overtaken");
+}
+
+// 1 Mbit/s with a 3000-byte burst and a 10 kB queue: a burst of 100 datagrams of 1000 bytes
+// keeps about 13 and drains them at the link rate
+void rate_limit() {
+    ImpairmentConfig config;
+    config.rate_bps = 1000000;
+    config.burst_bytes = 3000;
+    config.queue_limit_bytes = 10000;
+    Recorder rec;
+    NetworkImpairment net({config}, 11, rec.sink());
+    for (uint32_t seq = 0; seq < 100; ++seq) submit_seq(net, seq, 1000);
+    CHECK(drain(net), "rate-limited run did not drain");
+    net.stop();
+
+    const ImpairmentStats s = net.stats(0);
+    CHECK(s.queue_drops >= 84 && s.queue_drops <= 90, "%llu queue drops, expected ~87",
+          static_cast<unsigned long long>(s.queue_drops));
+    CHECK(is_sorted(rec.seqs.begin(), rec.seqs.end()), "rate limit changed the order");
+
+    // Everything past the burst leaves at 8 ms per datagram: not early, whatever the scheduler does
+    if (rec.times.size() > 4) {
+        const auto span = chrono::duration_cast<chrono::milliseconds>(rec.times.back() - rec.times.front()).count();
+        const long long min_span = static_cast<long long>(rec.times.size() - 5) * 8;   // one interval of wakeup slack
+        CHECK(span >= min_span, "%zu datagrams drained in %lld ms, link needs %lld ms", rec.times.size(),
+              static_cast<long long>(span), min_span);
+    }
+}
+
+} // namespace
+
+int main() {
+    seed_determinism();
+    loss_rates();
+    duplicates_and_order();
+    rate_limit();
+    return test_result("impairment_test");
+}
@@ -0,0 +1,180 @@
+// pacer_test: Pacer sending through UdpSender into a pass-through NetworkImpairment whose sink
+// records every datagram, so nothing reaches the network. Checks the pacing rate, the
+// max_delay drain, priority for retransmissions, and drop_frame(): once it returns, the
+// frame's payload memory may be reused and none of it may appear on the wire.
+
+#include "pacer.hpp"
+#include "network_impairment.hpp"
+#include "udp_sender.hpp"
+#include "check.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+namespace {
+
+constexpr size_t PAYLOAD = 1176;                          // 1200 bytes on the wire
+constexpr int PORT = 9;                                   // discard; never reached
+constexpr uint8_t POISON = 0xEE;                          // written over dropped frames
+
+struct Sent {
+    uint32_t frame_id;
+    uint8_t block_index;
+    bool poisoned;
+    Clock::time_point at;
+};
+
+// Sender with a recording emulator in front of its sockets
+struct Harness {
+    mutex lock;
+    vector<Sent> sent;
+    UdpSender sender;
+
+    Harness() {
+        CHECK(sender.open({0}), "could not open a UDP socket");
+        sender.set_targets("127.0.0.1", {PORT});
+        sender.set_impairment(make_shared<NetworkImpairment>(
+            vector<ImpairmentConfig>{ImpairmentConfig{}}, 1,
+            [this](int, const sockaddr_in&, const uint8_t* data, size_t len) {
+                PacketView view;
+                if (!parse_packet_view(data, len, view)) return false;
+                bool poisoned = view.payload_size > 0 && view.payload[0] == POISON;
+                lock_guard<mutex> guard(lock);
+                sent.push_back({view.frame_id, view.block_index, poisoned, Clock::now()});
+                return true;
+            }));
+    }
+
+    size_t count() {
+        lock_guard<mutex> guard(lock);
+        return sent.size();
+    }
+
+    bool wait_for(size_t n, int timeout_ms) {
+        auto until = Clock::now() + chrono::milliseconds(timeout_ms);
+        while (count() < n && Clock::now() < until) this_thread::sleep_for(chrono::milliseconds(1));
+        return count() >= n;
+    }
+};
+
+// One frame's packets over a payload buffer the test owns
+struct Frame {
+    vector<uint8_t> memory;
+    vector<PacketView> packets;
+
+    Frame(uint32_t frame_id, size_t count) : memory(count * PAYLOAD, 0x11) {
+        for (size_t i = 0; i < count; ++i) {
+            PacketView pkt;
+            pkt.k = static_cast<uint8_t>(count);
+            pkt.r = 0;
+            pkt.block_index = static_cast<uint8_t>(i);
+            pkt.block_size = PAYLOAD;
+            pkt.frame_id = frame_id;
+            pkt.frame_length = static_cast<uint32_t>(memory.size());
+            pkt.payload = &memory[i * PAYLOAD];
+            pkt.payload_size = PAYLOAD;
+            packets.push_back(pkt);
+        }
+    }
+};
+
+// 40 packets at 1 Mbit/s: 9.6 ms each, ~375 ms for the run after the 1 ms burst credit
+void pacing_rate() {
+    Harness h;
+    Pacer pacer(h.sender, "127.0.0.1", {PORT}, chrono::milliseconds(10000), false);
+    pacer.set_rate(1000000);
+    Frame frame(1, 40);
+    pacer.enqueue(frame.packets);
+    CHECK(h.wait_for(40, 3000), "%zu of 40 packets sent", h.count());
+    pacer.stop();
+
+    lock_guard<mutex> guard(h.lock);
+    if (h.sent.size() == 40) {
+        const auto span = chrono::duration_cast<chrono::milliseconds>(h.sent.back().at - h.sent.front().at).count();
+        CHECK(span >= 340, "40 packets left in %lld ms at 1 Mbit/s, expected ~375", static_cast<long long>(span));
+    }
+}
+
+// max_delay wins over the target rate: the same 40 packets at 100 kbit/s would take ~4 s
+void max_delay_drain() {
+    Harness h;
+    Pacer pacer(h.sender, "127.0.0.1", {PORT}, chrono::milliseconds(50), false);
+    pacer.set_rate(100000);
+    Frame frame(1, 40);
+    const auto start = Clock::now();
+    pacer.enqueue(frame.packets);
+    CHECK(h.wait_for(40, 3000), "%zu of 40 packets sent", h.count());
+    const auto took = chrono::duration_cast<chrono::milliseconds>(Clock::now() - start).count();
+    CHECK(took < 1000, "backlog took %lld ms to drain with a 50 ms max_delay", static_cast<long long>(took));
+}
+
+// A retransmission enqueued behind a paced frame goes out next
+void priority() {
+    Harness h;
+    Pacer pacer(h.sender, "127.0.0.1", {PORT}, chrono::milliseconds(10000), false);
+    pacer.set_rate(1000000);
+    Frame bulk(1, 30), retransmit(2, 1);
+    pacer.enqueue(bulk.packets);
+    CHECK(h.wait_for(2, 1000), "pacer did not start");
+    pacer.enqueue(retransmit.packets, true);
+    CHECK(h.wait_for(31, 3000), "%zu of 31 packets sent", h.count());
+    pacer.stop();
+
+    lock_guard<mutex> guard(h.lock);
+    size_t position = h.sent.size();
+    for (size_t i = 0; i < h.sent.size(); ++i)
+        if (h.sent[i].frame_id == 2) position = i;
+    CHECK(position < 10, "retransmission sent at position %zu of 31", position);
+}
+
+// Drop a frame while it is being paced out, then poison its memory: nothing poisoned may be
+// sent, and every packet is accounted for as either sent or dropped
+void drop_frame() {
+    Harness h;
+    Pacer pacer(h.sender, "127.0.0.1", {PORT}, chrono::milliseconds(10000), false);
+    pacer.set_rate(1000000);
+    Frame evicted(1, 40), next(2, 5);
+    pacer.enqueue(evicted.packets);
+    pacer.enqueue(next.packets);
+    CHECK(h.wait_for(5, 1000), "pacer did not start");
+
+    const size_t dropped = pacer.drop_frame(1);
+    memset(evicted.memory.data(), POISON, evicted.memory.size());
+    CHECK(pacer.drop_frame(1) == 0, "second drop_frame found packets");
+    CHECK(pacer.dropped() == dropped, "dropped() is %llu, drop_frame returned %zu",
+          static_cast<unsigned long long>(pacer.dropped()), dropped);
+
+    const size_t expected = 40 - dropped + 5;
+    CHECK(h.wait_for(expected, 3000), "%zu of %zu packets sent", h.count(), expected);
+    this_thread::sleep_for(chrono::milliseconds(50));   // nothing else may trickle out
+    pacer.stop();
+
+    lock_guard<mutex> guard(h.lock);
+    CHECK(h.sent.size() == expected, "%zu packets sent, expected %zu", h.sent.size(), expected);
+    size_t frame1 = 0, frame2 = 0, poisoned = 0;
+    for (const Sent& s : h.sent) {
+        frame1 += s.frame_id == 1;
+        frame2 += s.frame_id == 2;
+        poisoned += s.poisoned;
+    }
+    CHECK(dropped > 0 && frame1 + dropped == 40, "frame 1: %zu sent, %zu dropped", frame1, dropped);
+    CHECK(frame2 == 5, "frame 2: %zu of 5 sent", frame2);
+    CHECK(poisoned == 0, "%zu packets read memory released by drop_frame", poisoned);
+}
+
+} // namespace
+
+int main() {
+    pacing_rate();
+    max_delay_drain();
+    priority();
+    drop_frame();
+    return test_result("pacer_test");
+}
@@ -0,0 +1,131 @@
+// timer_wheel_test: TimerWheel on a virtual clock. Timers spread over all four levels must
+// fire exactly once, in deadline order, never early and no later than the advance() that
+// passes their deadline; cancellation (including stale ids) and rescheduling from the
+// handler are covered, and ms_until_next() must never report a wakeup later than the truth.
+
+#include "timer_wheel.hpp"
+#include "check.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace std;
+using Clock = TimerWheel::Clock;
+
+namespace {
+
+const Clock::time_point T0 = Clock::time_point(chrono::seconds(1000));
+
+Clock::time_point at_ms(int64_t ms) { return T0 + chrono::milliseconds(ms); }
+
+void rounding() {
+    TimerWheel wheel(T0);
+    vector<uint64_t> fired;
+    auto record = [&](uint64_t tag) { fired.push_back(tag); };
+
+    wheel.schedule(T0 + chrono::microseconds(1500), 1);   // rounds up to 2 ms
+    wheel.schedule(at_ms(-50), 2);                        // already due
+    wheel.advance(at_ms(0), record);
+    CHECK(fired == vector<uint64_t>{2}, "past deadline not fired on the next advance");
+    wheel.advance(at_ms(1), record);
+    CHECK(fired.size() == 1, "1.5 ms timer fired at 1 ms");
+    wheel.advance(at_ms(2), record);
+    CHECK(fired.size() == 2 && fired[1] == 1, "1.5 ms timer not fired at 2 ms");
+    CHECK(wheel.pending() == 0, "%zu timers still pending", wheel.pending());
+    CHECK(wheel.ms_until_next(77, at_ms(2)) == 77, "empty wheel must return max_ms");
+}
+
+// Deadlines up to 2^25 ms reach level 3; advance() steps are random, from 1 ms to hours
+void ordering_and_cancel(mt19937& rng) {
+    TimerWheel wheel(T0);
+    constexpr int TIMERS = 4000;
+    uniform_int_distribution<int> level(0, 3);
+
+    vector<int64_t> deadline(TIMERS);
+    vector<TimerWheel::TimerId> ids(TIMERS);
+    vector<bool> cancelled(TIMERS, false);
+    for (int i = 0; i < TIMERS; ++i) {
+        const int64_t range = int64_t(1) << (8 * level(rng) + 1);
+        deadline[i] = uniform_int_distribution<int64_t>(1, range)(rng);
+        ids[i] = wheel.schedule(at_ms(deadline[i]), i);
+    }
+    for (int i = 0; i < TIMERS; i += 3) {
+        cancelled[i] = wheel.cancel(ids[i]);
+        CHECK(cancelled[i], "cancel of armed timer %d failed", i);
+        CHECK(!wheel.cancel(ids[i]), "timer %d cancelled twice", i);
+    }
+    CHECK(!wheel.cancel(0), "cancel(0) succeeded");
+
+    vector<int> fire_count(TIMERS, 0);
+    int64_t now = 0, previous = 0, last_deadline = 0;
+    while (wheel.pending() > 0) {
+        // Never late: the next live deadline is not before the reported wakeup
+        int64_t next_due = INT64_MAX;
+        for (int i = 0; i < TIMERS; ++i)
+            if (!cancelled[i] && fire_count[i] == 0) next_due = min(next_due, deadline[i]);
+        const int wait = wheel.ms_until_next(1 << 30, at_ms(now));
+        CHECK(now + wait <= next_due, "at %lld ms: wakeup in %d ms, next deadline %lld",
+              static_cast<long long>(now), wait, static_cast<long long>(next_due));
+
+        const int magnitude = uniform_int_distribution<int>(0, 24)(rng);
+        now += uniform_int_distribution<int64_t>(1, int64_t(1) << magnitude)(rng);
+        wheel.advance(at_ms(now), [&](uint64_t tag) {
+            const int i = static_cast<int>(tag);
+            ++fire_count[i];
+            CHECK(!cancelled[i], "cancelled timer %d fired", i);
+            CHECK(deadline[i] <= now && deadline[i] > previous, "timer %d due at %lld fired in (%lld, %lld]", i,
+                  static_cast<long long>(deadline[i]), static_cast<long long>(previous), static_cast<long long>(now));
+            CHECK(deadline[i] >= last_deadline, "timer %d fired out of order", i);
+            last_deadline = deadline[i];
+        });
+        previous = now;
+    }
+
+    int wrong = 0;
+    for (int i = 0; i < TIMERS; ++i) wrong += fire_count[i] != (cancelled[i] ? 0 : 1);
+    CHECK(wrong == 0, "%d timers fired the wrong number of times", wrong);
+
+    // Ids of fired timers are stale, even once their nodes are reused
+    const TimerWheel::TimerId reused = wheel.schedule(at_ms(now + 10), 7);
+    for (int i = 1; i < TIMERS; i += 3) CHECK(!wheel.cancel(ids[i]), "stale id of timer %d cancelled a live timer", i);
+    CHECK(wheel.pending() == 1, "stale cancel disarmed the new timer");
+    CHECK(wheel.cancel(reused), "new timer could not be cancelled");
+}
+
+// A handler that re-arms its own timer, as the collector's playout deadline does
+void reschedule_from_handler() {
+    TimerWheel wheel(T0);
+    map<uint64_t, vector<int64_t>> fired;
+    int64_t now = 0;
+    wheel.schedule(at_ms(10), 1);
+    wheel.schedule(at_ms(0), 2);
+
+    const TimerWheel::ExpireHandler handler = [&](uint64_t tag) {
+        fired[tag].push_back(now);
+        if (tag == 1 && fired[1].size() < 50) wheel.schedule(at_ms(now + 10), 1);
+        // Due immediately: lands on the next tick, never the one being processed
+        if (tag == 2 && fired[2].size() < 3) wheel.schedule(at_ms(now), 2);
+    };
+    for (now = 0; now <= 1000; now += 5) wheel.advance(at_ms(now), handler);
+
+    CHECK(fired[1].size() == 50, "periodic timer fired %zu times", fired[1].size());
+    bool periodic = true;
+    for (size_t i = 1; i < fired[1].size(); ++i) periodic &= fired[1][i] - fired[1][i - 1] == 10;
+    CHECK(periodic, "periodic timer drifted");
+    // advance(0) fires it once; advance(5) covers tick 1 (the re-arm) and tick 5 (its re-arm)
+    CHECK(fired[2] == (vector<int64_t>{0, 5, 5}), "immediate re-arm fired %zu times", fired[2].size());
+    CHECK(wheel.pending() == 0, "%zu timers left", wheel.pending());
+}
+
+} // namespace
+
+int main() {
+    mt19937 rng(0x71CE);
+    rounding();
+    ordering_and_cancel(rng);
+    reschedule_from_handler();
+    return test_result("timer_wheel_test");
+}
@@ -0,0 +1,256 @@
+// wire_format_test: the v2 media packet header and the NACK and receiver report feedback
+// packets byte for byte, round trips through every parser, and rejection of truncated or
+// inconsistent datagrams.
+
+#include "packet_parser.hpp"
+#include "feedback.hpp"
+#include "check.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+ChunkPacket sample_packet() {
+    ChunkPacket pkt;
+    pkt.k = 8;
+    pkt.r = 4;
+    pkt.block_index = 11;
+    pkt.group_index = 0x0302;
+    pkt.block_size = 5;
+    pkt.frame_id = 0x07060504;
+    pkt.frame_length = 0x0B0A0908;
+    pkt.timestamp = 0x131211100F0E0D0CLL;
+    pkt.payload = {0xA0, 0xA1, 0xA2, 0xA3, 0xA4};
+    return pkt;
+}
+
+bool same_header(const PacketHeader& a, const PacketHeader& b) {
+    return a.version == b.version && a.k == b.k && a.r == b.r && a.block_index == b.block_index &&
+           a.group_index == b.group_index && a.block_size == b.block_size && a.frame_id == b.frame_id &&
+           a.frame_length == b.frame_length && a.timestamp == b.timestamp;
+}
+
+// The documented layout, little endian, independent of the struct
+void packet_header_layout() {
+    const vector<uint8_t> wire = serialize_packet(sample_packet());
+    const uint8_t expected[] = {
+        PACKET_VERSION, 8, 4, 11,                  // version, k, r, block_index
+        0x02, 0x03, 0x05, 0x00,                    // group_index, block_size
+        0x04, 0x05, 0x06, 0x07,                    // frame_id
+        0x08, 0x09, 0x0A, 0x0B,                    // frame_length
+        0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13,   // timestamp
+        0xA0, 0xA1, 0xA2, 0xA3, 0xA4,              // payload
+    };
+    CHECK(wire.size() == sizeof(expected), "serialized %zu bytes, expected %zu", wire.size(), sizeof(expected));
+    CHECK(wire.size() == sizeof(expected) && memcmp(wire.data(), expected, sizeof(expected)) == 0,
+          "serialized bytes differ from the documented layout");
+
+    // write_packet_header always stamps the current version
+    PacketHeader hdr = sample_packet();
+    hdr.version = 1;
+    uint8_t out[PACKET_HEADER_SIZE];
+    write_packet_header(hdr, out);
+    CHECK(out[0] == PACKET_VERSION, "header written with version %d", out[0]);
+}
+
+void packet_round_trip() {
+    const ChunkPacket pkt = sample_packet();
+    const vector<uint8_t> wire = serialize_packet(pkt);
+
+    ChunkPacket parsed = parse_packet(wire.data(), wire.size());
+    CHECK(same_header(parsed, pkt), "parse_packet header differs");
+    CHECK(parsed.payload == pkt.payload, "parse_packet payload differs");
+
+    PacketView view;
+    CHECK(parse_packet_view(wire.data(), wire.size(), view), "parse_packet_view rejected a valid packet");
+    CHECK(same_header(view, pkt), "parse_packet_view header differs");
+    CHECK(view.payload == wire.data() + PACKET_HEADER_SIZE && view.payload_size == pkt.payload.size(),
+          "view does not point at the payload in place");
+}
+
+// Each corruption must be rejected by both parsers
+void packet_rejects() {
+    const vector<uint8_t> good = serialize_packet(sample_packet());
+
+    struct Case {
+        const char* name;
+        vector<uint8_t> wire;
+    };
+    vector<Case> cases;
+    cases.push_back({"empty", {}});
+    cases.push_back({"header only", vector<uint8_t>(good.begin(), good.begin() + PACKET_HEADER_SIZE)});
+    cases.push_back({"truncated header", vector<uint8_t>(good.begin(), good.begin() + PACKET_HEADER_SIZE - 1)});
+    cases.push_back({"short payload", vector<uint8_t>(good.begin(), good.end() - 1)});
+    Case longer{"long payload", good};
+    longer.wire.push_back(0);
+    cases.push_back(longer);
+    Case version{"version 1", good};
+    version.wire[0] = 1;
+    cases.push_back(version);
+    Case no_data{"k = 0", good};
+    no_data.wire[1] = 0;
+    cases.push_back(no_data);
+    Case index{"block_index = k + r", good};
+    index.wire[3] = 12;
+    cases.push_back(index);
+
+    for (const Case& c : cases) {
+        PacketView view;
+        CHECK(!parse_packet_view(c.wire.data(), c.wire.size(), view), "parse_packet_view accepted: %s", c.name);
+        bool threw = false;
+        try {
+            parse_packet(c.wire.data(), c.wire.size());
+        } catch (const runtime_error&) {
+            threw = true;
+        }
+        CHECK(threw, "parse_packet accepted: %s", c.name);
+    }
+}
+
+void group_count() {
+    PacketHeader hdr;
+    hdr.k = 4;
+    hdr.block_size = 100;
+    hdr.frame_length = 400;
+    CHECK(hdr.group_count() == 1, "400 bytes in 4x100 blocks: %u groups", hdr.group_count());
+    hdr.frame_length = 401;
+    CHECK(hdr.group_count() == 2, "401 bytes in 4x100 blocks: %u groups", hdr.group_count());
+    hdr.k = 0;
+    CHECK(hdr.group_count() == 0, "k = 0 must not divide by zero");
+}
+
+void nack_format() {
+    NackEntry entries[2];
+    entries[0].frame_id = 0x04030201;
+    entries[0].group_index = 0x0605;
+    entries[0].budget_ms = 0x0807;
+    entries[0].missing_mask = 0x100F0E0D0C0B0A09ULL;
+    entries[1].frame_id = 7;
+    entries[1].missing_mask = 1;
+
+    vector<uint8_t> wire(NACK_HEADER_SIZE + 2 * sizeof(NackEntry));
+    CHECK(write_nack(entries, 2, wire.data()) == wire.size(), "write_nack size");
+    const uint8_t expected[] = {
+        FEEDBACK_NACK, 2, 0, 0,
+        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,   // frame_id, group_index, budget_ms
+        0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10,   // missing_mask
+    };
+    CHECK(memcmp(wire.data(), expected, sizeof(expected)) == 0, "NACK bytes differ from the documented layout");
+    CHECK(feedback_type(wire.data(), wire.size()) == FEEDBACK_NACK, "NACK not recognised");
+
+    // Media packets share the sockets: their first byte is the packet version
+    const vector<uint8_t> media = serialize_packet(sample_packet());
+    CHECK(feedback_type(media.data(), media.size()) == 0, "media packet taken for feedback");
+    CHECK(feedback_type(nullptr, 0) == 0, "empty datagram taken for feedback");
+
+    vector<NackEntry> parsed;
+    CHECK(parse_nack(wire.data(), wire.size(), parsed) && parsed.size() == 2, "parse_nack rejected a valid NACK");
+    if (parsed.size() == 2) {
+        CHECK(parsed[0].frame_id == entries[0].frame_id && parsed[0].group_index == entries[0].group_index &&
+              parsed[0].budget_ms == entries[0].budget_ms && parsed[0].missing_mask == entries[0].missing_mask,
+              "NACK entry 0 round trip");
+        CHECK(parsed[1].frame_id == 7 && parsed[1].missing_mask == 1, "NACK entry 1 round trip");
+    }
+
+    // Truncated, padded, miscounted or mistyped
+    CHECK(!parse_nack(wire.data(), wire.size() - 1, parsed), "truncated NACK accepted");
+    vector<uint8_t> padded = wire;
+    padded.push_back(0);
+    CHECK(!parse_nack(padded.data(), padded.size(), parsed), "padded NACK accepted");
+    vector<uint8_t> miscounted = wire;
+    miscounted[1] = 3;
+    CHECK(!parse_nack(miscounted.data(), miscounted.size(), parsed), "NACK with a wrong count accepted");
+    vector<uint8_t> mistyped = wire;
+    mistyped[0] = FEEDBACK_REPORT;
+    CHECK(!parse_nack(mistyped.data(), mistyped.size(), parsed), "report parsed as NACK");
+
+    // More entries than fit in one datagram are cut at MAX_NACK_ENTRIES
+    vector<NackEntry> many(MAX_NACK_ENTRIES + 5);
+    vector<uint8_t> big(NACK_HEADER_SIZE + many.size() * sizeof(NackEntry));
+    size_t written = write_nack(many.data(), many.size(), big.data());
+    CHECK(written == NACK_HEADER_SIZE + MAX_NACK_ENTRIES * sizeof(NackEntry), "oversized NACK wrote %zu bytes", written);
+    CHECK(parse_nack(big.data(), written, parsed) && parsed.size() == MAX_NACK_ENTRIES, "capped NACK round trip");
+}
+
+void report_format() {
+    ReceiverReport report;
+    report.highest_frame_id = 0x04030201;
+    report.played_frame_id = 0x08070605;
+    report.echo_timestamp_us = 0x100F0E0D0C0B0A09LL;
+    report.hold_us = 0x14131211;
+    report.echo_port = 0x1615;
+    report.frame_loss_mask = 0x201F1E1D1C1B1A19ULL;
+    ReportPath paths[2];
+    paths[0].port = 0x2221;
+    paths[0].received = 0x26252423;
+    paths[1].port = 5001;
+    paths[1].received = 7;
+    ArrivalSample arrivals[1];
+    arrivals[0].send_us = 0x2E2D2C2B2A292827LL;
+    arrivals[0].arrival_us = -5;
+
+    const size_t size = REPORT_HEADER_SIZE + sizeof(ReceiverReport) + 2 * sizeof(ReportPath) + sizeof(ArrivalSample);
+    vector<uint8_t> wire(size);
+    CHECK(write_receiver_report(report, paths, 2, arrivals, 1, wire.data()) == size, "write_receiver_report size");
+    const uint8_t expected[] = {
+        FEEDBACK_REPORT, 2, 1, 0,
+        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,   // highest, played
+        0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10,   // echo_timestamp_us
+        0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x00, 0x00,   // hold_us, echo_port, reserved
+        0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20,   // frame_loss_mask
+        0x21, 0x22, 0x00, 0x00, 0x23, 0x24, 0x25, 0x26,   // path 0
+    };
+    CHECK(memcmp(wire.data(), expected, sizeof(expected)) == 0, "report bytes differ from the documented layout");
+    CHECK(feedback_type(wire.data(), wire.size()) == FEEDBACK_REPORT, "report not recognised");
+
+    ReceiverReport parsed;
+    vector<ReportPath> parsed_paths;
+    vector<ArrivalSample> parsed_arrivals;
+    bool ok = parse_receiver_report(wire.data(), wire.size(), parsed, parsed_paths, parsed_arrivals);
+    CHECK(ok, "parse_receiver_report rejected a valid report");
+    CHECK(parsed.highest_frame_id == report.highest_frame_id && parsed.played_frame_id == report.played_frame_id &&
+          parsed.echo_timestamp_us == report.echo_timestamp_us && parsed.hold_us == report.hold_us &&
+          parsed.echo_port == report.echo_port && parsed.frame_loss_mask == report.frame_loss_mask,
+          "report fields round trip");
+    CHECK(parsed_paths.size() == 2 && parsed_paths[1].port == 5001 && parsed_paths[1].received == 7 &&
+          parsed_paths[0].received == paths[0].received, "report paths round trip");
+    CHECK(parsed_arrivals.size() == 1 && parsed_arrivals[0].send_us == arrivals[0].send_us &&
+          parsed_arrivals[0].arrival_us == -5, "report arrivals round trip");
+
+    CHECK(!parse_receiver_report(wire.data(), wire.size() - 1, parsed, parsed_paths, parsed_arrivals),
+          "truncated report accepted");
+    vector<uint8_t> miscounted = wire;
+    miscounted[2] = 2;
+    CHECK(!parse_receiver_report(miscounted.data(), miscounted.size(), parsed, parsed_paths, parsed_arrivals),
+          "report with a wrong arrival count accepted");
+    vector<uint8_t> too_many = wire;
+    too_many[1] = MAX_REPORT_PATHS + 1;
+    CHECK(!parse_receiver_report(too_many.data(), too_many.size(), parsed, parsed_paths, parsed_arrivals),
+          "report with too many paths accepted");
+    vector<uint8_t> nack(NACK_HEADER_SIZE);
+    write_nack(nullptr, 0, nack.data());
+    CHECK(!parse_receiver_report(nack.data(), nack.size(), parsed, parsed_paths, parsed_arrivals),
+          "NACK parsed as a report");
+
+    // Bare report: no paths, no arrivals
+    vector<uint8_t> bare(REPORT_HEADER_SIZE + sizeof(ReceiverReport));
+    CHECK(write_receiver_report(report, nullptr, 0, nullptr, 0, bare.data()) == bare.size(), "bare report size");
+    CHECK(parse_receiver_report(bare.data(), bare.size(), parsed, parsed_paths, parsed_arrivals) &&
+          parsed_paths.empty() && parsed_arrivals.empty(), "bare report round trip");
+}
+
+} // namespace
+
+int main() {
+    packet_header_layout();
+    packet_round_trip();
+    packet_rejects();
+    group_count();
+    nack_format();
+    report_format();
+    return test_result("wire_format_test");
+}